@@ -1,12 +1,15 @@
 #include "Calculator.h"
 
+#include <array>
 #include <cctype>
 #include <iostream>
 #include <memory>
 #include <stack>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <variant>
 #include <vector>
 #include <algorithm>
@@ -16,349 +19,530 @@ namespace calculator {
 using Value = database::DBType;
 
 Value Calculator::add(const Value& a, const Value& b) {
-    return applyOperator("+", a, b);
+    return applyOperator(Opcode::ADD, a, b);
 }
 
 Value Calculator::subtract(const Value& a, const Value& b) {
-    return applyOperator("-", a, b);
+    return applyOperator(Opcode::SUBTRACT, a, b);
 }
 
 Value Calculator::multiply(const Value& a, const Value& b) {
-    return applyOperator("*", a, b);
+    return applyOperator(Opcode::MULTIPLY, a, b);
 }
 
 Value Calculator::divide(const Value& a, const Value& b) {
-    return applyOperator("/", a, b);
+    return applyOperator(Opcode::DIVIDE, a, b);
 }
 
 Value Calculator::evaluate(
     const std::string& expression,
     const std::unordered_map<std::string, std::string>& external_values) const {
-    std::vector<std::string> tokens = tokenize(expression, external_values);
+    CompiledExpression compiled =
+        build(tokenize(expression), [&](const std::string& name) {
+            auto it = external_values.find(name);
+            if (it == external_values.end()) {
+                throw std::invalid_argument("Unknown variable: " + name);
+            }
+            CompiledExpression::Node node;
+            node.value = parseExternalValue(it->second);
+            return node;
+        });
+    compiled.bind({});
+    return compiled.evaluate({});
+}
+
+CompiledExpression Calculator::compile(const std::string& expression,
+                                       const ColumnBinding& binding) const {
+    CompiledExpression compiled =
+        build(tokenize(expression), [&](const std::string& name) {
+            auto it = binding.find(name);
+            if (it == binding.end()) {
+                throw std::invalid_argument("Unknown variable: " + name);
+            }
+            CompiledExpression::Node node;
+            node.type = CompiledExpression::NodeType::COLUMN;
+            node.slot = it->second;
+            return node;
+        });
+    compiled.optimize();
+    return compiled;
+}
+
+CompiledExpression Calculator::compile(
+    const std::string& expression,
+    const std::map<std::string, size_t>& columns) const {
+    ColumnBinding binding;
+    bindColumns(binding, columns);
+    return compile(expression, binding);
+}
+
+CompiledExpression Calculator::compile(
+    const std::string& expression, const database::SchemeType& scheme) const {
+    ColumnBinding binding;
+    bindColumns(binding, scheme);
+    return compile(expression, binding);
+}
+
+Value Calculator::evaluate(const CompiledExpression& expression,
+                           const database::RowType& row) const {
+    return expression.evaluate(row);
+}
+
+Value Calculator::evaluate(const CompiledExpression& expression,
+                           const database::RowType& row,
+                           const database::RowType& joinedRow) const {
+    return expression.evaluate(row, joinedRow);
+}
+
+void Calculator::evaluateBatch(const CompiledExpression& expression,
+                               const database::RowType* rows, size_t count,
+                               SelectionVector& selection) const {
+    expression.select(rows, count, selection);
+}
+
+void Calculator::bindColumns(ColumnBinding& binding,
+                             const std::map<std::string, size_t>& columns,
+                             size_t row, const std::string& prefix) {
+    for (const auto& [name, offset] : columns) {
+        binding[prefix.empty() ? name : prefix + '.' + name] = {row, offset,
+                                                                std::nullopt};
+    }
+}
 
-    std::vector<std::string> outputQueue;
-    std::stack<std::string> operatorStack;
+void Calculator::bindColumns(ColumnBinding& binding,
+                             const database::SchemeType& scheme, size_t row,
+                             const std::string& prefix) {
+    for (size_t offset = 0; offset < scheme.size(); ++offset) {
+        const std::string& name = scheme[offset].name;
+        binding[prefix.empty() ? name : prefix + '.' + name] = {
+            row, offset, scheme[offset].type};
+    }
+}
 
+CompiledExpression Calculator::build(const std::vector<Token>& tokens,
+                                     const IdentifierResolver& resolve) const {
+    using Node = CompiledExpression::Node;
+    using NodeType = CompiledExpression::NodeType;
+
+    struct PendingOperator {
+        Opcode op;
+        bool unary = false;
+        bool bracket = false;
+    };
+
+    CompiledExpression compiled;
+    std::vector<size_t> operands;
+    std::stack<PendingOperator> operatorStack;
+
+    auto reduce = [&](const PendingOperator& pending) {
+        Node node;
+        node.type = pending.unary ? NodeType::UNARY : NodeType::BINARY;
+        node.op = pending.op;
+        if (pending.unary) {
+            if (operands.empty()) {
+                throw std::invalid_argument(
+                    "Not enough operands for the operation.");
+            }
+            node.lhs = operands.back();
+            operands.pop_back();
+        } else {
+            if (operands.size() < 2) {
+                throw std::invalid_argument(
+                    "Not enough operands for the operation.");
+            }
+            node.rhs = operands.back();
+            operands.pop_back();
+            node.lhs = operands.back();
+            operands.pop_back();
+        }
+        compiled.nodes_.push_back(std::move(node));
+        operands.push_back(compiled.nodes_.size() - 1);
+    };
+
+    bool expectOperand = true;
     for (const auto& token : tokens) {
-        if (std::isdigit(token[0] &&
-                         !(token.length() > 1 && token[1] == 'x')) ||
-            (token[0] == '-' && token.size() > 1 && std::isdigit(token[1])) ||
-            (token[0] == '.' && token.size() > 1)) {
-            outputQueue.push_back(token);
-        } else if (token == "true" || token == "false") {
-            outputQueue.push_back(token);
-        } else if (isOperator(token)) {
-            while (!operatorStack.empty() && isOperator(operatorStack.top()) &&
-                   getPrecedence(operatorStack.top()) >= getPrecedence(token)) {
-                outputQueue.push_back(operatorStack.top());
-                operatorStack.pop();
+        switch (token.type) {
+            case TokenType::IDENTIFIER:
+                compiled.nodes_.push_back(resolve(token.text));
+                operands.push_back(compiled.nodes_.size() - 1);
+                expectOperand = false;
+                break;
+            case TokenType::PARAMETER: {
+                Node node;
+                node.type = NodeType::PARAMETER;
+                node.slot.offset = std::stoul(token.text) - 1;
+                compiled.nodes_.push_back(std::move(node));
+                operands.push_back(compiled.nodes_.size() - 1);
+                expectOperand = false;
+                break;
             }
-            operatorStack.push(token);
-        } else if (token == "(") {
-            operatorStack.push(token);
-        } else if (token == ")") {
-            while (!operatorStack.empty() && operatorStack.top() != "(") {
-                outputQueue.push_back(operatorStack.top());
+            case TokenType::LEFT_BRACKET:
+                operatorStack.push({Opcode::ADD, false, true});
+                expectOperand = true;
+                break;
+            case TokenType::RIGHT_BRACKET:
+                while (!operatorStack.empty() && !operatorStack.top().bracket) {
+                    reduce(operatorStack.top());
+                    operatorStack.pop();
+                }
+                if (operatorStack.empty()) {
+                    throw std::invalid_argument("Incorrect brackets.");
+                }
                 operatorStack.pop();
+                expectOperand = false;
+                break;
+            case TokenType::OPERATOR:
+                if (expectOperand || token.op == Opcode::NOT) {
+                    if (token.op == Opcode::SUBTRACT) {
+                        operatorStack.push({Opcode::NEGATE, true, false});
+                    } else if (token.op == Opcode::NOT) {
+                        operatorStack.push({Opcode::NOT, true, false});
+                    } else {
+                        throw std::invalid_argument(
+                            "Not enough operands for the operation.");
+                    }
+                } else {
+                    while (!operatorStack.empty() &&
+                           !operatorStack.top().bracket &&
+                           (operatorStack.top().unary ||
+                            getPrecedence(operatorStack.top().op) >=
+                                getPrecedence(token.op))) {
+                        reduce(operatorStack.top());
+                        operatorStack.pop();
+                    }
+                    operatorStack.push({token.op, false, false});
+                }
+                expectOperand = true;
+                break;
+            default: {
+                Node node;
+                node.value = parseLiteral(token);
+                compiled.nodes_.push_back(std::move(node));
+                operands.push_back(compiled.nodes_.size() - 1);
+                expectOperand = false;
+                break;
             }
-            if (operatorStack.empty()) {
-                throw std::invalid_argument("Incorrect brackets.");
-            }
-            operatorStack.pop();
-        } else {
-            outputQueue.push_back(token);
         }
     }
 
     while (!operatorStack.empty()) {
-        if (operatorStack.top() == "(" || operatorStack.top() == ")") {
+        if (operatorStack.top().bracket) {
             throw std::invalid_argument("Incorrect brackets.");
         }
-        outputQueue.push_back(operatorStack.top());
+        reduce(operatorStack.top());
         operatorStack.pop();
     }
 
-    std::stack<Value> valueStack;
-    for (const auto& token : outputQueue) {
-        if (isOperator(token)) {
-            if (token == "-" && valueStack.size() == 1) {
-                Value a = valueStack.top();
-                valueStack.pop();
-                Value result = applyOperator("negate", a, 0);
-                valueStack.push(result);
-            } else {
-                if (valueStack.size() < 2) {
-                    throw std::invalid_argument(
-                        "Not enough operands for the operation.");
-                }
-                Value b = valueStack.top();
-                valueStack.pop();
-                Value a = valueStack.top();
-                valueStack.pop();
-                Value result = applyOperator(token, a, b);
-                valueStack.push(result);
-            }
-        } else {
-            if ((std::isdigit(token[0]) &&
-                 !(token.length() > 1 && token[1] == 'x')) ||
-                (token[0] == '-' && token.size() > 1 &&
-                 std::isdigit(token[1])) ||
-                (token[0] == '.' && token.size() > 1)) {
-                if (token.find('.') != std::string::npos) {
-                    valueStack.push(std::stod(token));
-                } else {
-                    valueStack.push(std::stoi(token));
-                }
-            } else if (token == "true" || token == "false") {
-                valueStack.push(token == "true");
-            } else if (token.length() > 1 && token[1] == 'x') {
-                database::bytebuffer newBuffer = {};
-                for (size_t i = 2; i < token.length(); i += 2) {
-                    newBuffer.push_back(static_cast<char>(
-                        std::stoi(token.substr(i, 2), nullptr, 16)));
-                }
-                valueStack.emplace(newBuffer);
-            } else {
-                valueStack.emplace(std::string(token));
-            }
-        }
-    }
-
-    if (valueStack.size() != 1) {
+    if (operands.size() != 1) {
         throw std::invalid_argument("Incorrect expression.");
     }
-
-    return valueStack.top();
+    compiled.root_ = operands.back();
+    return compiled;
 }
 
-std::vector<std::string> Calculator::tokenize(
-    const std::string& expression,
-    const std::unordered_map<std::string, std::string>& external_values) const {
-    std::vector<std::string> tokens;
-    std::string token;
-    bool inString = false;
+std::vector<Calculator::Token> Calculator::tokenize(
+    const std::string& expression) const {
+    std::vector<Token> tokens;
 
     for (size_t i = 0; i < expression.length(); ++i) {
         char ch = expression[i];
 
-        if (inString) {
-            if (ch == '"') {
-                inString = false;
-                tokens.push_back(token);
-                token.clear();
-            } else {
-                token += ch;
-            }
-            continue;
-        }
-
         if (std::isspace(ch)) {
             continue;
         }
 
         if (ch == '"') {
-            if (!token.empty()) {
-                tokens.push_back(token);
-                token.clear();
+            size_t end = expression.find('"', i + 1);
+            if (end == std::string::npos) {
+                throw std::invalid_argument("Unterminated string literal.");
             }
-            inString = true;
+            tokens.push_back(
+                {TokenType::STRING, expression.substr(i + 1, end - i - 1)});
+            i = end;
             continue;
         }
 
-        if (std::isdigit(ch) || ch == '.' ||
-            (ch == '-' && (i == 0 || expression[i - 1] == '(' ||
-                           isOperator(std::string(1, expression[i - 1]))))) {
-            token += ch;
-        } else if (std::isalpha(ch)) {
-            while (i < expression.length() &&
-                   (std::isdigit(expression[i]) ||
-                    std::isalpha(expression[i]) || expression[i] == '_' ||
-                    expression[i] == '.')) {
-                token += expression[i];
-                ++i;
+        if (std::isdigit(ch) || ch == '.' || std::isalpha(ch) || ch == '_') {
+            size_t end = i;
+            while (end < expression.length() &&
+                   (std::isalnum(expression[end]) || expression[end] == '_' ||
+                    expression[end] == '.')) {
+                ++end;
             }
-            --i;
-            if (token == "true" || token == "false" ||
-                (token.substr(0, 2) == "0x" && token.length() % 2 == 0)) {
-                tokens.push_back(token);
-            } else {
-                if (external_values.find(token) != external_values.end()) {
-                    tokens.push_back(external_values.at(token));
-                } else {
-                    throw std::invalid_argument("Unknown variable: " + token);
+            std::string word = expression.substr(i, end - i);
+            i = end - 1;
+
+            if (word == "true" || word == "false") {
+                tokens.push_back({TokenType::BOOL, word});
+            } else if (word.substr(0, 2) == "0x") {
+                if (word.length() % 2 != 0) {
+                    throw std::invalid_argument("Unknown variable: " + word);
+                }
+                tokens.push_back({TokenType::BYTES, word});
+            } else if (std::isdigit(ch) || ch == '.') {
+                if (word.find_first_not_of("0123456789.") !=
+                    std::string::npos) {
+                    throw std::invalid_argument("Unknown variable: " + word);
                 }
+                tokens.push_back({TokenType::NUMBER, word});
+            } else {
+                tokens.push_back({TokenType::IDENTIFIER, word});
             }
-            token.clear();
-        } else {
-            if (!token.empty()) {
-                tokens.push_back(token);
-                token.clear();
+            continue;
+        }
+
+        if (ch == '?') {
+            size_t end = i + 1;
+            while (end < expression.length() &&
+                   std::isdigit(expression[end])) {
+                ++end;
             }
-            if (ch == '(' || ch == ')') {
-                tokens.emplace_back(1, ch);
-            } else {
-                std::string op;
-                op += ch;
-                if ((ch == '&' || ch == '|' || ch == '=' || ch == '!') &&
-                    (i + 1 < expression.length())) {
-                    if (expression[i + 1] == ch || expression[i + 1] == '=') {
-                        op += expression[i + 1];
-                        ++i;
-                    }
-                } else if (ch == '^' && (i + 1 < expression.length()) &&
-                           expression[i + 1] == '^') {
-                    op += expression[i + 1];
-                    ++i;
-                }
-                tokens.push_back(op);
+            if (end == i + 1 || expression[i + 1] == '0') {
+                throw std::invalid_argument("Incorrect parameter.");
             }
+            tokens.push_back(
+                {TokenType::PARAMETER, expression.substr(i + 1, end - i - 1)});
+            i = end - 1;
+            continue;
         }
-    }
-    if (!token.empty()) {
-        tokens.push_back(token);
+
+        if (ch == '(') {
+            tokens.push_back({TokenType::LEFT_BRACKET, "("});
+            continue;
+        }
+        if (ch == ')') {
+            tokens.push_back({TokenType::RIGHT_BRACKET, ")"});
+            continue;
+        }
+
+        std::string op(1, ch);
+        if (i + 1 < expression.length()) {
+            char next = expression[i + 1];
+            if (((ch == '&' || ch == '|' || ch == '^') && next == ch) ||
+                ((ch == '=' || ch == '!' || ch == '<' || ch == '>') &&
+                 next == '=')) {
+                op += next;
+                ++i;
+            }
+        }
+        Opcode opcode;
+        if (!lexOperator(op, opcode)) {
+            throw std::invalid_argument("Incorrect operation: " + op);
+        }
+        tokens.push_back({TokenType::OPERATOR, op, opcode});
     }
 
     return tokens;
 }
 
-int Calculator::getPrecedence(const std::string& operator_) {
-    if (operator_ == "||") {
-        return 1;
+Value Calculator::parseLiteral(const Token& token) {
+    switch (token.type) {
+        case TokenType::NUMBER:
+            if (token.text.find('.') != std::string::npos) {
+                return std::stod(token.text);
+            }
+            return std::stoi(token.text);
+        case TokenType::BOOL:
+            return token.text == "true";
+        case TokenType::BYTES: {
+            database::bytebuffer newBuffer = {};
+            for (size_t i = 2; i < token.text.length(); i += 2) {
+                newBuffer.push_back(static_cast<char>(
+                    std::stoi(token.text.substr(i, 2), nullptr, 16)));
+            }
+            return newBuffer;
+        }
+        default:
+            return token.text;
     }
-    if (operator_ == "&&") {
-        return 2;
+}
+
+Value Calculator::parseExternalValue(const std::string& text) {
+    if (text == "true" || text == "false") {
+        return parseLiteral({TokenType::BOOL, text});
     }
-    if (operator_ == "==" || operator_ == "!=") {
-        return 3;
+    if (text.substr(0, 2) == "0x" && text.length() % 2 == 0) {
+        return parseLiteral({TokenType::BYTES, text});
     }
-    if (operator_ == "<" || operator_ == "<=" || operator_ == ">" ||
-        operator_ == ">=") {
-        return 4;
+    size_t digits = text[0] == '-' ? 1 : 0;
+    if (text.length() > digits &&
+        text.find_first_not_of("0123456789.", digits) == std::string::npos &&
+        text.find_first_of("0123456789", digits) != std::string::npos) {
+        if (text.find('.') != std::string::npos) {
+            return std::stod(text);
+        }
+        return std::stoi(text);
     }
-    if (operator_ == "+" || operator_ == "-") {
-        return 5;
+    return text;
+}
+
+bool Calculator::lexOperator(const std::string& text, Opcode& op) {
+    static const std::pair<const char*, Opcode> operators[] = {
+        {"+", Opcode::ADD},         {"-", Opcode::SUBTRACT},
+        {"*", Opcode::MULTIPLY},    {"/", Opcode::DIVIDE},
+        {"%", Opcode::MODULO},      {"&&", Opcode::AND},
+        {"||", Opcode::OR},         {"^^", Opcode::XOR},
+        {"==", Opcode::EQUAL},      {"!=", Opcode::NOT_EQUAL},
+        {"<", Opcode::LESS},        {"<=", Opcode::LESS_EQUAL},
+        {">", Opcode::GREATER},     {">=", Opcode::GREATER_EQUAL},
+        {"!", Opcode::NOT}};
+    for (const auto& [name, opcode] : operators) {
+        if (text == name) {
+            op = opcode;
+            return true;
+        }
     }
-    if (operator_ == "*" || operator_ == "/" || operator_ == "%") {
-        return 6;
+    return false;
+}
+
+int Calculator::getPrecedence(Opcode op) {
+    switch (op) {
+        case Opcode::OR:
+            return 1;
+        case Opcode::AND:
+            return 2;
+        case Opcode::EQUAL:
+        case Opcode::NOT_EQUAL:
+            return 3;
+        case Opcode::LESS:
+        case Opcode::LESS_EQUAL:
+        case Opcode::GREATER:
+        case Opcode::GREATER_EQUAL:
+            return 4;
+        case Opcode::ADD:
+        case Opcode::SUBTRACT:
+            return 5;
+        case Opcode::MULTIPLY:
+        case Opcode::DIVIDE:
+        case Opcode::MODULO:
+            return 6;
+        case Opcode::NEGATE:
+        case Opcode::NOT:
+            return 7;
+        default:
+            return 0;
     }
-    return 0;
 }
 
-bool Calculator::isOperator(const std::string& token) {
-    static const std::vector<std::string> operators = {
-        "+",  "-", "*", "/",  "%",  "&&", "||", "!",
-        "^^", "<", ">", "<=", ">=", "==", "!="};
-    return std::find(operators.begin(), operators.end(), token) !=
-           operators.end();
+namespace {
+
+template <typename T>
+constexpr bool isNumber = std::is_same_v<T, int> || std::is_same_v<T, double>;
+
+std::string_view bytesView(const database::bytebuffer& buffer) {
+    return {buffer.data(), buffer.size()};
 }
 
-Value Calculator::applyOperator(const std::string& op, const Value& a,
-                                const Value& b) {
-    return std::visit(
-        [&](auto&& lhs, auto&& rhs) -> Value {
-            using T1 = std::decay_t<decltype(lhs)>;
-            using T2 = std::decay_t<decltype(rhs)>;
+template <Opcode op, typename T>
+bool compare(const T& lhs, const T& rhs) {
+    if constexpr (op == Opcode::EQUAL) return lhs == rhs;
+    if constexpr (op == Opcode::NOT_EQUAL) return lhs != rhs;
+    if constexpr (op == Opcode::LESS) return lhs < rhs;
+    if constexpr (op == Opcode::LESS_EQUAL) return lhs <= rhs;
+    if constexpr (op == Opcode::GREATER) return lhs > rhs;
+    if constexpr (op == Opcode::GREATER_EQUAL) return lhs >= rhs;
+}
 
-            if (op == "negate") {
-                if constexpr (std::is_same_v<T1, int>) {
-                    return -lhs;
-                }
-                if constexpr (std::is_same_v<T1, double>) {
-                    return -lhs;
+// Implementation of one operator for one pair of operand types. Every
+// combination that is not handled here is an incorrect operation.
+template <Opcode op, typename T1, typename T2>
+Value applyTyped(const T1& lhs, [[maybe_unused]] const T2& rhs) {
+    constexpr bool isArithmetic =
+        op == Opcode::ADD || op == Opcode::SUBTRACT ||
+        op == Opcode::MULTIPLY || op == Opcode::DIVIDE || op == Opcode::MODULO;
+    constexpr bool isLogical =
+        op == Opcode::AND || op == Opcode::OR || op == Opcode::XOR;
+    constexpr bool isComparison =
+        op == Opcode::EQUAL || op == Opcode::NOT_EQUAL ||
+        op == Opcode::LESS || op == Opcode::LESS_EQUAL ||
+        op == Opcode::GREATER || op == Opcode::GREATER_EQUAL;
+
+    if constexpr (op == Opcode::NEGATE) {
+        if constexpr (isNumber<T1>) {
+            return -lhs;
+        }
+    } else if constexpr (op == Opcode::NOT) {
+        if constexpr (std::is_same_v<T1, bool>) {
+            return !lhs;
+        }
+    } else if constexpr (isArithmetic) {
+        if constexpr (std::is_same_v<T1, int> && std::is_same_v<T2, int>) {
+            if constexpr (op == Opcode::ADD) return lhs + rhs;
+            if constexpr (op == Opcode::SUBTRACT) return lhs - rhs;
+            if constexpr (op == Opcode::MULTIPLY) return lhs * rhs;
+            if constexpr (op == Opcode::DIVIDE || op == Opcode::MODULO) {
+                if (rhs == 0) {
+                    throw std::invalid_argument(
+                        "Division by zero is not possible!");
                 }
+                return op == Opcode::DIVIDE ? lhs / rhs : lhs % rhs;
             }
-
-            if constexpr ((std::is_same_v<T1, int> ||
-                           std::is_same_v<T1, double>) &&
-                          (std::is_same_v<T2, int> ||
-                           std::is_same_v<T2, double>)) {
-                if constexpr (std::is_same_v<T1, int> &&
-                              std::is_same_v<T2, int>) {
-                    if (op == "+") return lhs + rhs;
-                    if (op == "-") return lhs - rhs;
-                    if (op == "*") return lhs * rhs;
-                    if (op == "/") {
-                        if (rhs == 0) {
-                            throw std::invalid_argument(
-                                "Division by zero is not possible!");
-                        }
-                        return lhs / rhs;
-                    }
-                    if (op == "%") {
-                        if (rhs == 0) {
-                            throw std::invalid_argument(
-                                "Division by zero is not possible!");
-                        }
-                        return lhs % rhs;
-                    }
-                } else {
-                    double lhs_val = lhs;
-                    double rhs_val = rhs;
-                    if (op == "+") return lhs_val + rhs_val;
-                    if (op == "-") return lhs_val - rhs_val;
-                    if (op == "*") return lhs_val * rhs_val;
-                    if (op == "/") {
-                        if (rhs_val == 0.0) {
-                            throw std::invalid_argument(
-                                "Division by zero is not possible!");
-                        }
-                        return lhs_val / rhs_val;
-                    }
+        } else if constexpr (isNumber<T1> && isNumber<T2>) {
+            double lhs_val = lhs;
+            double rhs_val = rhs;
+            if constexpr (op == Opcode::ADD) return lhs_val + rhs_val;
+            if constexpr (op == Opcode::SUBTRACT) return lhs_val - rhs_val;
+            if constexpr (op == Opcode::MULTIPLY) return lhs_val * rhs_val;
+            if constexpr (op == Opcode::DIVIDE) {
+                if (rhs_val == 0.0) {
+                    throw std::invalid_argument(
+                        "Division by zero is not possible!");
                 }
+                return lhs_val / rhs_val;
             }
+        } else if constexpr (op == Opcode::ADD && std::is_same_v<T1, T2> &&
+                             (std::is_same_v<T1, std::string> ||
+                              std::is_same_v<T1, database::bytebuffer>)) {
+            T1 result = lhs;
+            result.insert(result.end(), rhs.begin(), rhs.end());
+            return result;
+        }
+    } else if constexpr (isLogical) {
+        if constexpr (std::is_same_v<T1, bool> && std::is_same_v<T2, bool>) {
+            if constexpr (op == Opcode::AND) return lhs && rhs;
+            if constexpr (op == Opcode::OR) return lhs || rhs;
+            if constexpr (op == Opcode::XOR) return lhs != rhs;
+        }
+    } else if constexpr (isComparison && std::is_same_v<T1, T2>) {
+        if constexpr (std::is_same_v<T1, database::bytebuffer>) {
+            return compare<op>(bytesView(lhs), bytesView(rhs));
+        } else if constexpr (!std::is_same_v<T1, bool>) {
+            return compare<op>(lhs, rhs);
+        } else if constexpr (op == Opcode::EQUAL ||
+                             op == Opcode::NOT_EQUAL) {
+            return compare<op>(lhs, rhs);
+        }
+    }
+    throw std::invalid_argument("Incorrect operation: " + opcodeToString(op));
+}
 
-            if constexpr (std::is_same_v<T1, bool> &&
-                          std::is_same_v<T2, bool>) {
-                if (op == "&&") return lhs && rhs;
-                if (op == "||") return lhs || rhs;
-                if (op == "^^") return lhs != rhs;
-            }
+using Kernel = Value (*)(const Value&, const Value&);
 
-            if constexpr (std::is_same_v<T1, std::string> &&
-                          std::is_same_v<T2, std::string>) {
-                if (op == "+") return lhs + rhs;
-            }
+constexpr size_t kTypeCount = std::variant_size_v<Value>;
 
-            if constexpr (std::is_same_v<T1, database::bytebuffer> &&
-                          std::is_same_v<T2, database::bytebuffer>) {
-                if (op == "+") {
-                    auto a = static_cast<database::bytebuffer>(lhs);
-                    auto b = static_cast<database::bytebuffer>(lhs);
-                    a.insert(a.end(), b.begin(), b.end());
-                    return a;
-                }
-            }
+template <Opcode op, size_t L, size_t R>
+Value kernel(const Value& a, const Value& b) {
+    return applyTyped<op>(*std::get_if<L>(&a), *std::get_if<R>(&b));
+}
 
-            if constexpr (std::is_same_v<T1, T2> &&
-                          (std::is_same_v<T1, int> ||
-                           std::is_same_v<T1, double> ||
-                           std::is_same_v<T1, std::string>)) {
-                if (op == "==") return lhs == rhs;
-                if (op == "!=") return lhs != rhs;
-                if (op == "<") return lhs < rhs;
-                if (op == "<=") return lhs <= rhs;
-                if (op == ">") return lhs > rhs;
-                if (op == ">=") return lhs >= rhs;
-            }
+template <size_t... I>
+constexpr std::array<Kernel, sizeof...(I)> makeKernels(
+    std::index_sequence<I...>) {
+    return {&kernel<static_cast<Opcode>(I / (kTypeCount * kTypeCount)),
+                    I / kTypeCount % kTypeCount, I % kTypeCount>...};
+}
 
-            if constexpr (std::is_same_v<T1, T2> &&
-                          std::is_same_v<T1, database::bytebuffer>) {
-                auto a = static_cast<database::bytebuffer>(lhs);
-                auto b = static_cast<database::bytebuffer>(rhs);
-                std::string str_a(a.begin(), a.end());
-                std::string str_b(b.begin(), b.end());
-
-                if (op == "==") return str_a == str_b;
-                if (op == "!=") return str_a != str_b;
-                if (op == "<") return str_a < str_b;
-                if (op == "<=") return str_a <= str_b;
-                if (op == ">") return str_a > str_b;
-                if (op == ">=") return str_a >= str_b;
-            }
+// One kernel per (opcode, lhs type, rhs type), indexed by the variant indices.
+constexpr auto kKernels = makeKernels(
+    std::make_index_sequence<kOpcodeCount * kTypeCount * kTypeCount>{});
 
-            throw std::invalid_argument("Incorrect operation: " + op);
-        },
-        a, b);
+}  // namespace
+
+Value Calculator::applyOperator(Opcode op, const Value& a, const Value& b) {
+    size_t index =
+        (static_cast<size_t>(op) * kTypeCount + a.index()) * kTypeCount +
+        b.index();
+    return kKernels[index](a, b);
 }
 
 }  // namespace calculator
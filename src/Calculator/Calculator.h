@@ -1,6 +1,8 @@
 #ifndef DATABASE_CONTROLLER_HSE_CALCULATOR_H
 #define DATABASE_CONTROLLER_HSE_CALCULATOR_H
 
+#include <functional>
+#include <map>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -9,6 +11,7 @@
 #include <vector>
 
 #include "../types.h"
+#include "CompiledExpression.h"
 
 namespace calculator {
 
@@ -41,16 +44,65 @@ class Calculator {
                    const std::unordered_map<std::string, std::string>&
                        external_values = {}) const;
 
-   private:
-    std::vector<std::string> tokenize(
+    CompiledExpression compile(const std::string& expression,
+                               const ColumnBinding& binding) const;
+    CompiledExpression compile(
         const std::string& expression,
-        const std::unordered_map<std::string, std::string>& external_values =
-            {}) const;
-    static int getPrecedence(const std::string& operator_);
-    static bool isOperator(const std::string& token);
-    static Value applyOperator(const std::string& op, const Value& a,
-                               const Value& b);
-    static bool applyLogicalOperator(const std::string& op, bool a, bool b);
+        const std::map<std::string, size_t>& columns) const;
+    // Same for the columns of a table, whose types let the optimizer
+    // rearrange more of the expression.
+    CompiledExpression compile(const std::string& expression,
+                               const database::SchemeType& scheme) const;
+
+    Value evaluate(const CompiledExpression& expression,
+                   const database::RowType& row) const;
+    Value evaluate(const CompiledExpression& expression,
+                   const database::RowType& row,
+                   const database::RowType& joinedRow) const;
+
+    void evaluateBatch(const CompiledExpression& expression,
+                       const database::RowType* rows, size_t count,
+                       SelectionVector& selection) const;
+
+    static void bindColumns(ColumnBinding& binding,
+                            const std::map<std::string, size_t>& columns,
+                            size_t row = 0, const std::string& prefix = "");
+    static void bindColumns(ColumnBinding& binding,
+                            const database::SchemeType& scheme,
+                            size_t row = 0, const std::string& prefix = "");
+
+   private:
+    friend class CompiledExpression;
+
+    enum class TokenType {
+        NUMBER,
+        STRING,
+        BOOL,
+        BYTES,
+        IDENTIFIER,
+        PARAMETER,
+        OPERATOR,
+        LEFT_BRACKET,
+        RIGHT_BRACKET
+    };
+
+    struct Token {
+        TokenType type;
+        std::string text;
+        Opcode op = Opcode::ADD;
+    };
+
+    using IdentifierResolver =
+        std::function<CompiledExpression::Node(const std::string&)>;
+
+    std::vector<Token> tokenize(const std::string& expression) const;
+    CompiledExpression build(const std::vector<Token>& tokens,
+                             const IdentifierResolver& resolve) const;
+    static Value parseLiteral(const Token& token);
+    static Value parseExternalValue(const std::string& text);
+    static bool lexOperator(const std::string& text, Opcode& op);
+    static int getPrecedence(Opcode op);
+    static Value applyOperator(Opcode op, const Value& a, const Value& b);
 };
 
 }  // namespace calculator
@@ -159,6 +159,216 @@ TEST_F(CalculatorTest, ByteBufferCompareFour) {
     EXPECT_TRUE(std::get<bool>(result));
 }
 
+TEST_F(CalculatorTest, CompiledExpressionColumns) {
+    std::map<std::string, size_t> columns = {
+        {"ID", 0}, {"Name", 1}, {"Age", 2}};
+    auto expression = calc.compile("Age > 20 && Name != \"Bob\"", columns);
+
+    RowType alice = {1, std::string("Alice"), 25};
+    RowType bob = {2, std::string("Bob"), 30};
+    RowType carl = {3, std::string("Carl"), 18};
+    EXPECT_TRUE(std::get<bool>(expression.evaluate(alice)));
+    EXPECT_FALSE(std::get<bool>(expression.evaluate(bob)));
+    EXPECT_FALSE(std::get<bool>(expression.evaluate(carl)));
+}
+
+TEST_F(CalculatorTest, CompiledExpressionArithmetic) {
+    std::map<std::string, size_t> columns = {{"a", 0}, {"b", 1}};
+    auto expression = calc.compile("-(a + b) * 2 <= -10", columns);
+    EXPECT_TRUE(std::get<bool>(expression.evaluate({2, 3})));
+    EXPECT_FALSE(std::get<bool>(expression.evaluate({1, 3})));
+}
+
+TEST_F(CalculatorTest, CompiledExpressionUnknownColumn) {
+    std::map<std::string, size_t> columns = {{"a", 0}};
+    EXPECT_THROW(calc.compile("a + c", columns), std::invalid_argument);
+    EXPECT_THROW(calc.compile("(a + 1", columns), std::invalid_argument);
+}
+
+TEST_F(CalculatorTest, CompiledExpressionJoinedRows) {
+    ColumnBinding binding;
+    Calculator::bindColumns(binding, {{"ID", 0}, {"Name", 1}}, 0, "User");
+    Calculator::bindColumns(binding, {{"ID", 0}, {"AuthorId", 1}}, 1, "Post");
+    auto expression = calc.compile("User.ID == Post.AuthorId", binding);
+
+    RowType user = {1, std::string("Alice")};
+    EXPECT_TRUE(std::get<bool>(calc.evaluate(expression, user, {7, 1})));
+    EXPECT_FALSE(std::get<bool>(calc.evaluate(expression, user, {1, 2})));
+}
+
+TEST_F(CalculatorTest, CompiledExpressionTypedValues) {
+    auto expression = calc.compile("Active == true && Code == \"007\"",
+                                   std::map<std::string, size_t>{
+                                       {"Active", 0}, {"Code", 1}});
+    EXPECT_TRUE(std::get<bool>(
+        calc.evaluate(expression, {true, std::string("007")})));
+    EXPECT_FALSE(std::get<bool>(
+        calc.evaluate(expression, {false, std::string("007")})));
+}
+
+TEST_F(CalculatorTest, EvaluateBatchSelection) {
+    std::map<std::string, size_t> columns = {{"a", 0}, {"b", 1}};
+    auto expression = calc.compile("a > 1500 && (b == true || a % 7 == 0)",
+                                   columns);
+    std::vector<RowType> rows;
+    for (int i = 0; i < 2500; ++i) {
+        rows.push_back({i, i % 2 == 0});
+    }
+
+    SelectionVector selection;
+    calc.evaluateBatch(expression, rows.data(), rows.size(), selection);
+    size_t expected = 0;
+    for (int i = 0; i < 2500; ++i) {
+        if (i > 1500 && (i % 2 == 0 || i % 7 == 0)) {
+            ASSERT_LT(expected, selection.size());
+            EXPECT_EQ(selection[expected++], static_cast<size_t>(i));
+        }
+    }
+    EXPECT_EQ(selection.size(), expected);
+}
+
+TEST_F(CalculatorTest, ByteBufferConcatenationDifferentOperands) {
+    bytebuffer buffer = {0x12, 0x34, 0x56};
+    Value result = calc.evaluate("0x1234 + 0x56");
+    EXPECT_EQ(std::get<bytebuffer>(result), buffer);
+}
+
+TEST_F(CalculatorTest, IncorrectOperandTypes) {
+    EXPECT_THROW(calc.evaluate("\"abc\" - \"a\""), std::invalid_argument);
+    EXPECT_THROW(calc.evaluate("true < false"), std::invalid_argument);
+    EXPECT_THROW(calc.evaluate("1 && true"), std::invalid_argument);
+    EXPECT_THROW(calc.evaluate("5.5 % 2"), std::invalid_argument);
+    EXPECT_THROW(calc.evaluate("1 % 0"), std::invalid_argument);
+    EXPECT_EQ(safeGet<bool>(calc.evaluate("!(1 > 2) && true != false")),
+              true);
+}
+
+TEST_F(CalculatorTest, ShortCircuitLogicalOperators) {
+    EXPECT_FALSE(std::get<bool>(calc.evaluate("false && 1 / 0 == 1")));
+    EXPECT_TRUE(std::get<bool>(calc.evaluate("true || 1 / 0 == 1")));
+    EXPECT_THROW(calc.evaluate("true && 1 / 0 == 1"), std::invalid_argument);
+}
+
+TEST_F(CalculatorTest, EvaluateBatchReorderedPredicate) {
+    SchemeType scheme = {{"a", DataTypeName::INT}, {"b", DataTypeName::INT}};
+    auto reordered = calc.compile(
+        "(a > 10 || b != 3) && a == 51 && !(b == 2)", scheme);
+    auto guarded = calc.compile("b != 0 && a / b > 10", scheme);
+    // the cheap and selective a == 1.5 would go first, but it throws
+    auto mistyped = calc.compile("a != 1 && a == 1.5", scheme);
+    std::vector<RowType> rows;
+    for (int i = 0; i < 100; ++i) {
+        rows.push_back({i, i % 4});
+    }
+
+    SelectionVector selection;
+    calc.evaluateBatch(reordered, rows.data(), rows.size(), selection);
+    EXPECT_EQ(selection, SelectionVector({51}));
+
+    selection.clear();
+    EXPECT_NO_THROW(
+        calc.evaluateBatch(guarded, rows.data(), rows.size(), selection));
+    size_t expected = 0;
+    for (int i = 0; i < 100; ++i) {
+        expected += i % 4 != 0 && i / (i % 4) > 10;
+    }
+    EXPECT_EQ(selection.size(), expected);
+
+    RowType row = {1, 1};
+    EXPECT_FALSE(std::get<bool>(calc.evaluate(mistyped, row)));
+    selection.clear();
+    EXPECT_NO_THROW(calc.evaluateBatch(mistyped, &row, 1, selection));
+    EXPECT_TRUE(selection.empty());
+}
+
+TEST_F(CalculatorTest, CompiledExpressionConstantFolding) {
+    std::map<std::string, size_t> columns = {{"a", 0}, {"b", 1}};
+    RowType row = {30, true};
+    EXPECT_TRUE(std::get<bool>(
+        calc.evaluate(calc.compile("a > 20 + 5", columns), row)));
+    EXPECT_TRUE(std::get<bool>(
+        calc.evaluate(calc.compile("40 - 5 > a", columns), row)));
+    EXPECT_TRUE(std::get<bool>(
+        calc.evaluate(calc.compile("true && a == 30", columns), row)));
+    EXPECT_TRUE(std::get<bool>(
+        calc.evaluate(calc.compile("!!(a == 30) || false", columns), row)));
+    EXPECT_TRUE(std::get<bool>(
+        calc.evaluate(calc.compile("b && true", columns), row)));
+    EXPECT_THROW(calc.evaluate(calc.compile("a && true", columns), row),
+                 std::invalid_argument);
+
+    SchemeType scheme = {{"a", DataTypeName::INT}, {"b", DataTypeName::BOOL}};
+    EXPECT_TRUE(calc.compile("a > 1 && 1 == 2", scheme).alwaysFalse());
+    EXPECT_TRUE(calc.compile("!(a > 1 || true)", scheme).alwaysFalse());
+    EXPECT_FALSE(calc.compile("a > 1 || 1 == 2", scheme).alwaysFalse());
+    // operands that may throw are not dropped: a column of unknown type, or
+    // one compared with a value of another type
+    EXPECT_FALSE(calc.compile("a > 1 && 1 == 2", columns).alwaysFalse());
+    EXPECT_THROW(
+        calc.evaluate(calc.compile("a == \"x\" && false", scheme), row),
+        std::invalid_argument);
+    EXPECT_THROW(calc.evaluate(calc.compile("a + 0.5 > b && false", scheme),
+                               row),
+                 std::invalid_argument);
+
+    auto divided = calc.compile("a > 1 / 0", columns);
+    EXPECT_THROW(calc.evaluate(divided, row), std::invalid_argument);
+}
+
+TEST_F(CalculatorTest, CompiledExpressionParameters) {
+    std::map<std::string, size_t> columns = {{"a", 0}};
+    auto expression = calc.compile("?2 < a && a < ?1 + 10", columns);
+    RowType row = {15};
+    EXPECT_THROW(expression.bind({Value(10)}), std::invalid_argument);
+
+    expression.bind({Value(10), Value(5)});
+    EXPECT_TRUE(std::get<bool>(calc.evaluate(expression, row)));
+    expression.bind({Value(0), Value(5)});
+    EXPECT_FALSE(std::get<bool>(calc.evaluate(expression, row)));
+
+    // bound values are folded like literals, and can be bound again
+    auto folded = calc.compile("?2 == 0 && a > ?1", columns);
+    EXPECT_FALSE(folded.alwaysFalse());
+    folded.bind({Value(1), Value(1)});
+    EXPECT_TRUE(folded.alwaysFalse());
+    folded.bind({Value(1), Value(0)});
+    EXPECT_FALSE(folded.alwaysFalse());
+    EXPECT_TRUE(std::get<bool>(calc.evaluate(folded, row)));
+
+    EXPECT_THROW(calc.evaluate("?1 + 1"), std::invalid_argument);
+    EXPECT_THROW(calc.compile("a > ?", columns), std::invalid_argument);
+}
+
+TEST_F(CalculatorTest, CompiledExpressionMayMatchRanges) {
+    std::map<std::string, size_t> columns = {{"a", 0}, {"s", 1}, {"d", 2}};
+    std::vector<ColumnRange> ranges = {{true, 10, 20},
+                                       {true, std::string("b"),
+                                        std::string("d")},
+                                       {false, {}, {}}};
+    auto mayMatch = [&](const std::string& expression) {
+        return calc.compile(expression, columns).mayMatch(ranges);
+    };
+    EXPECT_TRUE(mayMatch("a == 15"));
+    EXPECT_FALSE(mayMatch("a == 21"));
+    EXPECT_FALSE(mayMatch("a < 10"));
+    EXPECT_TRUE(mayMatch("a <= 10"));
+    EXPECT_FALSE(mayMatch("25 < a"));
+    EXPECT_TRUE(mayMatch("a >= 20"));
+    EXPECT_FALSE(mayMatch("s == \"e\""));
+    EXPECT_FALSE(mayMatch("a > 30 || s < \"b\""));
+    EXPECT_TRUE(mayMatch("a > 30 || s < \"c\""));
+    EXPECT_FALSE(mayMatch("a > 12 && a < 5"));
+    // columns without a range, mismatched types and other expressions
+    // may always match
+    EXPECT_TRUE(mayMatch("d > 100"));
+    EXPECT_TRUE(mayMatch("a > 25.5"));
+    EXPECT_TRUE(mayMatch("a + 1 > 100"));
+
+    ranges[0] = {true, 7, 7};
+    EXPECT_FALSE(mayMatch("a != 7"));
+    EXPECT_TRUE(mayMatch("a != 8"));
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,904 @@
+#include "CompiledExpression.h"
+
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <variant>
+
+#include "Calculator.h"
+
+namespace calculator {
+
+namespace {
+
+template <typename T>
+bool gatherColumn(const database::RowType* rows, size_t count, size_t offset,
+                  T* values) {
+    for (size_t i = 0; i < count; ++i) {
+        const T* value = std::get_if<T>(&rows[i][offset]);
+        if (value == nullptr) {
+            return false;
+        }
+        values[i] = *value;
+    }
+    return true;
+}
+
+// The loops below have no branches on the data, so for arithmetic types
+// the compiler turns them into vector compares.
+template <typename T, typename Compare>
+void compareLoop(const T* values, size_t count, const T& constant,
+                 uint8_t* mask, Compare compare) {
+    for (size_t i = 0; i < count; ++i) {
+        mask[i] = compare(values[i], constant);
+    }
+}
+
+template <typename T>
+bool compareKernel(Opcode op, const T* values, size_t count, const T& constant,
+                   uint8_t* mask) {
+    switch (op) {
+        case Opcode::EQUAL:
+            compareLoop(values, count, constant, mask, std::equal_to<>());
+            return true;
+        case Opcode::NOT_EQUAL:
+            compareLoop(values, count, constant, mask, std::not_equal_to<>());
+            return true;
+        default:
+            break;
+    }
+    if constexpr (!std::is_same_v<T, bool>) {
+        switch (op) {
+            case Opcode::LESS:
+                compareLoop(values, count, constant, mask, std::less<>());
+                return true;
+            case Opcode::LESS_EQUAL:
+                compareLoop(values, count, constant, mask,
+                            std::less_equal<>());
+                return true;
+            case Opcode::GREATER:
+                compareLoop(values, count, constant, mask, std::greater<>());
+                return true;
+            case Opcode::GREATER_EQUAL:
+                compareLoop(values, count, constant, mask,
+                            std::greater_equal<>());
+                return true;
+            default:
+                break;
+        }
+    }
+    return false;
+}
+
+Opcode flipComparison(Opcode op) {
+    switch (op) {
+        case Opcode::LESS:
+            return Opcode::GREATER;
+        case Opcode::LESS_EQUAL:
+            return Opcode::GREATER_EQUAL;
+        case Opcode::GREATER:
+            return Opcode::LESS;
+        case Opcode::GREATER_EQUAL:
+            return Opcode::LESS_EQUAL;
+        default:
+            return op;
+    }
+}
+
+// A value of the given alternative of Value, to try operators on.
+Value sampleValue(size_t type) {
+    switch (type) {
+        case 0:
+            return 1;
+        case 1:
+            return 1.0;
+        case 2:
+            return true;
+        case 3:
+            return std::string();
+        default:
+            return database::bytebuffer();
+    }
+}
+
+bool isConstant(const CompiledExpression::Node& node) {
+    return node.type == CompiledExpression::NodeType::LITERAL ||
+           node.type == CompiledExpression::NodeType::PARAMETER;
+}
+
+const int* columnValues(const ColumnSource& source, size_t offset,
+                        size_t begin, size_t count, int* buffer) {
+    return source.ints(offset, begin, count, buffer);
+}
+
+const double* columnValues(const ColumnSource& source, size_t offset,
+                           size_t begin, size_t count, double* buffer) {
+    return source.doubles(offset, begin, count, buffer);
+}
+
+const bool* columnValues(const ColumnSource& source, size_t offset,
+                         size_t begin, size_t count, bool* buffer) {
+    return source.bools(offset, begin, count, buffer);
+}
+
+// ColumnSource over an array of RowType rows.
+class RowSource : public ColumnSource {
+   public:
+    explicit RowSource(const database::RowType* rows) : rows_(rows) {}
+
+    const int* ints(size_t offset, size_t begin, size_t count,
+                    int* buffer) const override {
+        return gatherColumn(rows_ + begin, count, offset, buffer) ? buffer
+                                                                  : nullptr;
+    }
+    const double* doubles(size_t offset, size_t begin, size_t count,
+                          double* buffer) const override {
+        return gatherColumn(rows_ + begin, count, offset, buffer) ? buffer
+                                                                  : nullptr;
+    }
+    const bool* bools(size_t offset, size_t begin, size_t count,
+                      bool* buffer) const override {
+        return gatherColumn(rows_ + begin, count, offset, buffer) ? buffer
+                                                                  : nullptr;
+    }
+    bool strings(size_t offset, size_t begin, size_t count,
+                 std::string_view* views) const override {
+        for (size_t i = 0; i < count; ++i) {
+            const auto* value =
+                std::get_if<std::string>(&rows_[begin + i][offset]);
+            if (value == nullptr) {
+                return false;
+            }
+            views[i] = *value;
+        }
+        return true;
+    }
+
+    Value value(size_t offset, size_t row) const override {
+        return rows_[row][offset];
+    }
+    const database::RowType* storedRow(size_t row) const override {
+        return &rows_[row];
+    }
+
+   private:
+    const database::RowType* rows_;
+};
+
+}  // namespace
+
+const int* ColumnSource::ints(size_t, size_t, size_t, int*) const {
+    return nullptr;
+}
+
+const double* ColumnSource::doubles(size_t, size_t, size_t, double*) const {
+    return nullptr;
+}
+
+const bool* ColumnSource::bools(size_t, size_t, size_t, bool*) const {
+    return nullptr;
+}
+
+bool ColumnSource::strings(size_t, size_t, size_t, std::string_view*) const {
+    return false;
+}
+
+const uint32_t* ColumnSource::codes(size_t, size_t, size_t, uint32_t*) const {
+    return nullptr;
+}
+
+bool ColumnSource::findCode(size_t, std::string_view, uint32_t&) const {
+    return false;
+}
+
+bool ColumnSource::compare(size_t, Opcode, const Value&, size_t, size_t,
+                           uint8_t*) const {
+    return false;
+}
+
+const database::RowType* ColumnSource::storedRow(size_t) const {
+    return nullptr;
+}
+
+std::string opcodeToString(Opcode op) {
+    switch (op) {
+        case Opcode::ADD:
+            return "+";
+        case Opcode::SUBTRACT:
+        case Opcode::NEGATE:
+            return "-";
+        case Opcode::MULTIPLY:
+            return "*";
+        case Opcode::DIVIDE:
+            return "/";
+        case Opcode::MODULO:
+            return "%";
+        case Opcode::AND:
+            return "&&";
+        case Opcode::OR:
+            return "||";
+        case Opcode::XOR:
+            return "^^";
+        case Opcode::EQUAL:
+            return "==";
+        case Opcode::NOT_EQUAL:
+            return "!=";
+        case Opcode::LESS:
+            return "<";
+        case Opcode::LESS_EQUAL:
+            return "<=";
+        case Opcode::GREATER:
+            return ">";
+        case Opcode::GREATER_EQUAL:
+            return ">=";
+        case Opcode::NOT:
+            return "!";
+    }
+    return "?";
+}
+
+Value CompiledExpression::evaluate(const database::RowType& row) const {
+    if (nodes_.empty()) {
+        throw std::invalid_argument("Incorrect expression.");
+    }
+    const Value* rows[] = {row.data(), row.data()};
+    return evaluateNode(root_, rows);
+}
+
+Value CompiledExpression::evaluate(const database::RowType& row,
+                                   const database::RowType& joinedRow) const {
+    return evaluate(row.data(), joinedRow.data());
+}
+
+Value CompiledExpression::evaluate(const Value* row,
+                                   const Value* joinedRow) const {
+    if (nodes_.empty()) {
+        throw std::invalid_argument("Incorrect expression.");
+    }
+    const Value* rows[] = {row, joinedRow};
+    return evaluateNode(root_, rows);
+}
+
+Value CompiledExpression::evaluateNode(size_t index,
+                                       const Value* const rows[]) const {
+    const Node& node = nodes_[index];
+    switch (node.type) {
+        case NodeType::LITERAL:
+        case NodeType::PARAMETER:
+            return node.value;
+        case NodeType::COLUMN:
+            return rows[node.slot.row][node.slot.offset];
+        case NodeType::UNARY: {
+            Value operand = evaluateNode(node.lhs, rows);
+            return Calculator::applyOperator(node.op, operand, operand);
+        }
+        case NodeType::BINARY: {
+            Value lhs = evaluateNode(node.lhs, rows);
+            if (node.op == Opcode::AND || node.op == Opcode::OR) {
+                const bool* value = std::get_if<bool>(&lhs);
+                if (value != nullptr && *value == (node.op == Opcode::OR)) {
+                    return lhs;
+                }
+            }
+            return Calculator::applyOperator(node.op, lhs,
+                                             evaluateNode(node.rhs, rows));
+        }
+    }
+    throw std::invalid_argument("Incorrect expression.");
+}
+
+void CompiledExpression::bind(const std::vector<Value>& parameters) {
+    for (const auto& node : unbound_.empty() ? nodes_ : unbound_) {
+        if (node.type == NodeType::PARAMETER &&
+            node.slot.offset >= parameters.size()) {
+            throw std::invalid_argument("Parameter ?" +
+                                        std::to_string(node.slot.offset + 1) +
+                                        " is not bound.");
+        }
+    }
+    if (unbound_.empty()) {
+        // nothing to optimize again: not optimized at all (see
+        // Calculator::evaluate), no placeholders or a lone one
+        for (auto& node : nodes_) {
+            if (node.type == NodeType::PARAMETER) {
+                node.value = parameters[node.slot.offset];
+            }
+        }
+        return;
+    }
+    nodes_.assign(unbound_.begin(), unbound_.end());
+    root_ = unboundRoot_;
+    for (auto& node : nodes_) {
+        if (node.type == NodeType::PARAMETER) {
+            node.type = NodeType::LITERAL;
+            node.value = parameters[node.slot.offset];
+        }
+    }
+    optimize();
+}
+
+void CompiledExpression::optimize() {
+    if (nodes_.empty()) {
+        return;
+    }
+    root_ = simplify(root_);
+    root_ = reorderOperands(root_);
+    bool hasParameters = std::any_of(
+        nodes_.begin(), nodes_.end(),
+        [](const Node& node) { return node.type == NodeType::PARAMETER; });
+    if (hasParameters && nodes_.size() > 1) {
+        unbound_ = nodes_;
+        unboundRoot_ = root_;
+    }
+}
+
+bool CompiledExpression::alwaysFalse() const {
+    if (nodes_.empty()) {
+        return false;
+    }
+    const Node& root = nodes_[root_];
+    const bool* value = std::get_if<bool>(&root.value);
+    return root.type == NodeType::LITERAL && value != nullptr && !*value;
+}
+
+bool CompiledExpression::mayMatch(
+    const std::vector<ColumnRange>& ranges) const {
+    if (nodes_.empty()) {
+        return true;
+    }
+    return !alwaysFalse() && mayMatch(root_, ranges);
+}
+
+bool CompiledExpression::mayMatch(
+    size_t index, const std::vector<ColumnRange>& ranges) const {
+    const Node& node = nodes_[index];
+    if (node.type != NodeType::BINARY) {
+        return true;
+    }
+    if (node.op == Opcode::AND) {
+        return mayMatch(node.lhs, ranges) && mayMatch(node.rhs, ranges);
+    }
+    if (node.op == Opcode::OR) {
+        return mayMatch(node.lhs, ranges) || mayMatch(node.rhs, ranges);
+    }
+
+    const Node* column = &nodes_[node.lhs];
+    const Node* constant = &nodes_[node.rhs];
+    Opcode op = node.op;
+    if (isConstant(*column) && constant->type == NodeType::COLUMN) {
+        std::swap(column, constant);
+        op = flipComparison(op);
+    }
+    if (column->type != NodeType::COLUMN || !isConstant(*constant) ||
+        column->slot.offset >= ranges.size()) {
+        return true;
+    }
+    const ColumnRange& range = ranges[column->slot.offset];
+    const Value& value = constant->value;
+    if (!range.known || range.min.index() != value.index()) {
+        return true;
+    }
+    switch (op) {
+        case Opcode::EQUAL:
+            return !(value < range.min) && !(range.max < value);
+        case Opcode::NOT_EQUAL:
+            return !(range.min == value && range.max == value);
+        case Opcode::LESS:
+            return range.min < value;
+        case Opcode::LESS_EQUAL:
+            return !(value < range.min);
+        case Opcode::GREATER:
+            return value < range.max;
+        case Opcode::GREATER_EQUAL:
+            return !(range.max < value);
+        default:
+            return true;
+    }
+}
+
+std::vector<std::pair<size_t, Value>> CompiledExpression::equalities() const {
+    std::vector<std::pair<size_t, Value>> result;
+    if (!nodes_.empty()) {
+        collectEqualities(root_, result);
+    }
+    return result;
+}
+
+void CompiledExpression::collectEqualities(
+    size_t index, std::vector<std::pair<size_t, Value>>& equalities) const {
+    const Node& node = nodes_[index];
+    if (node.type != NodeType::BINARY) {
+        return;
+    }
+    if (node.op == Opcode::AND) {
+        collectEqualities(node.lhs, equalities);
+        collectEqualities(node.rhs, equalities);
+        return;
+    }
+    if (node.op != Opcode::EQUAL) {
+        return;
+    }
+    const Node* column = &nodes_[node.lhs];
+    const Node* constant = &nodes_[node.rhs];
+    if (isConstant(*column)) {
+        std::swap(column, constant);
+    }
+    if (column->type == NodeType::COLUMN && column->slot.row == 0 &&
+        isConstant(*constant)) {
+        equalities.emplace_back(column->slot.offset, constant->value);
+    }
+}
+
+size_t CompiledExpression::simplify(size_t index) {
+    if (nodes_[index].type == NodeType::UNARY) {
+        size_t operand = simplify(nodes_[index].lhs);
+        nodes_[index].lhs = operand;
+        const Node& node = nodes_[index];
+        const Node& child = nodes_[operand];
+        if (child.type == NodeType::LITERAL) {
+            return foldConstant(index);
+        }
+        // !!x is x as long as x is known to be a bool
+        if (node.op == Opcode::NOT && child.type == NodeType::UNARY &&
+            child.op == Opcode::NOT && isBoolean(child.lhs)) {
+            return child.lhs;
+        }
+        return index;
+    }
+    if (nodes_[index].type != NodeType::BINARY) {
+        return index;
+    }
+
+    size_t lhs = simplify(nodes_[index].lhs);
+    size_t rhs = simplify(nodes_[index].rhs);
+    Node& node = nodes_[index];
+    node.lhs = lhs;
+    node.rhs = rhs;
+    bool lhsLiteral = nodes_[lhs].type == NodeType::LITERAL;
+    bool rhsLiteral = nodes_[rhs].type == NodeType::LITERAL;
+    if (lhsLiteral && rhsLiteral) {
+        return foldConstant(index);
+    }
+
+    if (node.op == Opcode::AND || node.op == Opcode::OR) {
+        // true && x -> x, false && x -> false, and dually for ||. A literal
+        // on the right may only drop the left operand if evaluating it could
+        // not have thrown.
+        bool absorbing = node.op == Opcode::OR;
+        auto literalBool = [&](size_t operand) {
+            return std::get_if<bool>(&nodes_[operand].value);
+        };
+        if (lhsLiteral && literalBool(lhs) != nullptr) {
+            if (*literalBool(lhs) == absorbing) {
+                return lhs;
+            }
+            if (isBoolean(rhs)) {
+                return rhs;
+            }
+        }
+        if (rhsLiteral && literalBool(rhs) != nullptr && isBoolean(lhs)) {
+            if (*literalBool(rhs) != absorbing) {
+                return lhs;
+            }
+            if (!mayFail(lhs)) {
+                return rhs;
+            }
+        }
+        return index;
+    }
+
+    // constant <op> column -> column <flipped op> constant
+    if (isConstant(nodes_[lhs]) && nodes_[rhs].type == NodeType::COLUMN) {
+        switch (node.op) {
+            case Opcode::EQUAL:
+            case Opcode::NOT_EQUAL:
+            case Opcode::LESS:
+            case Opcode::LESS_EQUAL:
+            case Opcode::GREATER:
+            case Opcode::GREATER_EQUAL:
+                std::swap(node.lhs, node.rhs);
+                node.op = flipComparison(node.op);
+                break;
+            default:
+                break;
+        }
+    }
+    return index;
+}
+
+size_t CompiledExpression::foldConstant(size_t index) {
+    const Node& node = nodes_[index];
+    const Value& lhs = nodes_[node.lhs].value;
+    const Value& rhs =
+        node.type == NodeType::UNARY ? lhs : nodes_[node.rhs].value;
+    Node folded;
+    try {
+        folded.value = Calculator::applyOperator(node.op, lhs, rhs);
+    } catch (const std::exception&) {
+        // Errors such as division by zero are reported when the expression
+        // is evaluated, not when it is compiled.
+        return index;
+    }
+    nodes_[index] = std::move(folded);
+    return index;
+}
+
+bool CompiledExpression::isBoolean(size_t index) const {
+    const Node& node = nodes_[index];
+    switch (node.type) {
+        case NodeType::LITERAL:
+            return std::holds_alternative<bool>(node.value);
+        case NodeType::COLUMN:
+        case NodeType::PARAMETER:
+            return false;
+        case NodeType::UNARY:
+            return node.op == Opcode::NOT;
+        case NodeType::BINARY:
+            switch (node.op) {
+                case Opcode::AND:
+                case Opcode::OR:
+                case Opcode::EQUAL:
+                case Opcode::NOT_EQUAL:
+                case Opcode::LESS:
+                case Opcode::LESS_EQUAL:
+                case Opcode::GREATER:
+                case Opcode::GREATER_EQUAL:
+                    return true;
+                default:
+                    return false;
+            }
+    }
+    return false;
+}
+
+size_t CompiledExpression::reorderOperands(size_t index) {
+    Node& node = nodes_[index];
+    if (node.type == NodeType::UNARY) {
+        size_t operand = reorderOperands(node.lhs);
+        nodes_[index].lhs = operand;
+        return index;
+    }
+    if (node.type != NodeType::BINARY) {
+        return index;
+    }
+    if (node.op != Opcode::AND && node.op != Opcode::OR) {
+        size_t lhs = reorderOperands(node.lhs);
+        size_t rhs = reorderOperands(node.rhs);
+        nodes_[index].lhs = lhs;
+        nodes_[index].rhs = rhs;
+        return index;
+    }
+
+    Opcode op = node.op;
+    std::vector<size_t> chain;
+    std::vector<size_t> operands;
+    collectChain(index, op, chain, operands);
+    for (auto& operand : operands) {
+        operand = reorderOperands(operand);
+    }
+
+    // Moving an operand that may fail (division by zero, operands of
+    // unknown or mismatched types) in front of the one guarding it would
+    // raise an error the source order avoids, so such chains are kept.
+    bool canReorder = true;
+    for (size_t operand : operands) {
+        canReorder &= !mayFail(operand);
+    }
+    if (canReorder) {
+        // Cheap operands that decide the result most often go first: for &&
+        // those that are rarely true, for || those that are often true.
+        auto rank = [&](size_t operand) {
+            double selectivity = estimateSelectivity(operand);
+            double decides =
+                op == Opcode::AND ? 1.0 - selectivity : selectivity;
+            return estimateCost(operand) / std::max(decides, 0.01);
+        };
+        std::stable_sort(operands.begin(), operands.end(),
+                         [&](size_t a, size_t b) { return rank(a) < rank(b); });
+    }
+
+    size_t lhs = operands[0];
+    for (size_t i = 1; i < operands.size(); ++i) {
+        Node& link = nodes_[chain[i - 1]];
+        link.lhs = lhs;
+        link.rhs = operands[i];
+        lhs = chain[i - 1];
+    }
+    return lhs;
+}
+
+void CompiledExpression::collectChain(size_t index, Opcode op,
+                                      std::vector<size_t>& chain,
+                                      std::vector<size_t>& operands) const {
+    const Node& node = nodes_[index];
+    if (node.type == NodeType::BINARY && node.op == op) {
+        chain.push_back(index);
+        collectChain(node.lhs, op, chain, operands);
+        collectChain(node.rhs, op, chain, operands);
+    } else {
+        operands.push_back(index);
+    }
+}
+
+bool CompiledExpression::mayFail(size_t index) const {
+    const Node& node = nodes_[index];
+    switch (node.type) {
+        case NodeType::UNARY:
+            return mayFail(node.lhs) || !valueType(index);
+        case NodeType::BINARY:
+            return node.op == Opcode::DIVIDE || node.op == Opcode::MODULO ||
+                   mayFail(node.lhs) || mayFail(node.rhs) ||
+                   !valueType(index);
+        default:
+            return false;
+    }
+}
+
+std::optional<size_t> CompiledExpression::valueType(size_t index) const {
+    const Node& node = nodes_[index];
+    switch (node.type) {
+        case NodeType::LITERAL:
+            return node.value.index();
+        case NodeType::PARAMETER:
+            return std::nullopt;
+        case NodeType::COLUMN:
+            if (!node.slot.type) {
+                return std::nullopt;
+            }
+            // the alternatives of Value follow the order of DataTypeName
+            return static_cast<size_t>(*node.slot.type);
+        case NodeType::UNARY:
+        case NodeType::BINARY:
+            break;
+    }
+    std::optional<size_t> lhs = valueType(node.lhs);
+    std::optional<size_t> rhs =
+        node.type == NodeType::UNARY ? lhs : valueType(node.rhs);
+    if (!lhs || !rhs) {
+        return std::nullopt;
+    }
+    // the operator kernel decides which operand types it accepts
+    try {
+        return Calculator::applyOperator(node.op, sampleValue(*lhs),
+                                         sampleValue(*rhs))
+            .index();
+    } catch (const std::exception&) {
+        return std::nullopt;
+    }
+}
+
+double CompiledExpression::estimateCost(size_t index) const {
+    const Node& node = nodes_[index];
+    switch (node.type) {
+        case NodeType::LITERAL:
+            return std::holds_alternative<std::string>(node.value) ||
+                           std::holds_alternative<database::bytebuffer>(
+                               node.value)
+                       ? 4.0
+                       : 0.0;
+        case NodeType::PARAMETER:
+            return 0.0;
+        case NodeType::COLUMN:
+            return 1.0;
+        case NodeType::UNARY:
+            return 1.0 + estimateCost(node.lhs);
+        case NodeType::BINARY:
+            return 1.0 + estimateCost(node.lhs) + estimateCost(node.rhs);
+    }
+    return 1.0;
+}
+
+double CompiledExpression::estimateSelectivity(size_t index) const {
+    const Node& node = nodes_[index];
+    if (node.type == NodeType::UNARY && node.op == Opcode::NOT) {
+        return 1.0 - estimateSelectivity(node.lhs);
+    }
+    if (node.type != NodeType::BINARY) {
+        return 0.5;
+    }
+    switch (node.op) {
+        case Opcode::EQUAL:
+            return 0.1;
+        case Opcode::NOT_EQUAL:
+            return 0.9;
+        case Opcode::LESS:
+        case Opcode::LESS_EQUAL:
+        case Opcode::GREATER:
+        case Opcode::GREATER_EQUAL:
+            return 0.33;
+        case Opcode::AND:
+            return estimateSelectivity(node.lhs) *
+                   estimateSelectivity(node.rhs);
+        case Opcode::OR: {
+            double lhs = estimateSelectivity(node.lhs);
+            double rhs = estimateSelectivity(node.rhs);
+            return lhs + rhs - lhs * rhs;
+        }
+        default:
+            return 0.5;
+    }
+}
+
+void CompiledExpression::select(const database::RowType* rows, size_t count,
+                                SelectionVector& selection) const {
+    select(RowSource(rows), 0, count, selection);
+}
+
+void CompiledExpression::select(const ColumnSource& source, size_t begin,
+                                size_t count,
+                                SelectionVector& selection) const {
+    if (alwaysFalse()) {
+        return;
+    }
+    if (nodes_.empty()) {
+        throw std::invalid_argument("Incorrect expression.");
+    }
+    uint8_t mask[kBatchSize];
+    size_t end = begin + count;
+    for (size_t first = begin; first < end; first += kBatchSize) {
+        size_t batch = std::min(kBatchSize, end - first);
+        evaluateMask(root_, source, first, batch, nullptr, mask);
+        for (size_t i = 0; i < batch; ++i) {
+            if (mask[i]) {
+                selection.push_back(first + i);
+            }
+        }
+    }
+}
+
+void CompiledExpression::evaluateMask(size_t index, const ColumnSource& source,
+                                      size_t begin, size_t count,
+                                      const uint8_t* active,
+                                      uint8_t* mask) const {
+    const Node& node = nodes_[index];
+    if (node.type == NodeType::BINARY &&
+        (node.op == Opcode::AND || node.op == Opcode::OR)) {
+        evaluateMask(node.lhs, source, begin, count, active, mask);
+
+        // the right side only matters where the left side did not decide
+        uint8_t rhsActive[kBatchSize];
+        bool anyActive = false;
+        uint8_t undecided = node.op == Opcode::AND ? 1 : 0;
+        for (size_t i = 0; i < count; ++i) {
+            rhsActive[i] = (active == nullptr || active[i]) &&
+                           mask[i] == undecided;
+            anyActive |= rhsActive[i];
+        }
+        if (!anyActive) {
+            return;
+        }
+
+        uint8_t rhsMask[kBatchSize];
+        evaluateMask(node.rhs, source, begin, count, rhsActive, rhsMask);
+        if (node.op == Opcode::AND) {
+            for (size_t i = 0; i < count; ++i) {
+                mask[i] &= rhsMask[i];
+            }
+        } else {
+            for (size_t i = 0; i < count; ++i) {
+                mask[i] |= rhsMask[i];
+            }
+        }
+        return;
+    }
+
+    if (node.type == NodeType::BINARY &&
+        compareColumnWithConstant(node, source, begin, count, mask)) {
+        return;
+    }
+
+    // storages without RowType rows get a row holding just the columns the
+    // expression reads
+    std::vector<size_t> offsets;
+    database::RowType scratch;
+    for (size_t i = 0; i < count; ++i) {
+        if (active != nullptr && !active[i]) {
+            mask[i] = 0;
+            continue;
+        }
+        const database::RowType* stored = source.storedRow(begin + i);
+        if (stored == nullptr) {
+            if (offsets.empty()) {
+                collectColumns(index, offsets);
+                size_t size = 0;
+                for (size_t offset : offsets) {
+                    size = std::max(size, offset + 1);
+                }
+                scratch.resize(size);
+            }
+            for (size_t offset : offsets) {
+                scratch[offset] = source.value(offset, begin + i);
+            }
+            stored = &scratch;
+        }
+        const Value* row[] = {stored->data(), stored->data()};
+        mask[i] = safeGet<bool>(evaluateNode(index, row));
+    }
+}
+
+bool CompiledExpression::compareColumnWithConstant(const Node& node,
+                                                   const ColumnSource& source,
+                                                   size_t begin, size_t count,
+                                                   uint8_t* mask) const {
+    const Node* column = &nodes_[node.lhs];
+    const Node* constant = &nodes_[node.rhs];
+    Opcode op = node.op;
+    if (isConstant(*column) && constant->type == NodeType::COLUMN) {
+        std::swap(column, constant);
+        op = flipComparison(op);
+    }
+    if (column->type != NodeType::COLUMN || !isConstant(*constant)) {
+        return false;
+    }
+
+    size_t offset = column->slot.offset;
+    if (source.compare(offset, op, constant->value, begin, count, mask)) {
+        return true;
+    }
+    return std::visit(
+        [&](const auto& value) -> bool {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, int> ||
+                          std::is_same_v<T, double> ||
+                          std::is_same_v<T, bool>) {
+                T buffer[kBatchSize];
+                const T* values =
+                    columnValues(source, offset, begin, count, buffer);
+                if (values == nullptr) {
+                    return false;
+                }
+                return compareKernel(op, values, count, value, mask);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                if (op != Opcode::EQUAL && op != Opcode::NOT_EQUAL) {
+                    return false;
+                }
+                uint32_t buffer[kBatchSize];
+                const uint32_t* codes =
+                    source.codes(offset, begin, count, buffer);
+                if (codes != nullptr) {
+                    uint32_t code;
+                    if (source.findCode(offset, value, code)) {
+                        compareKernel(op, codes, count, code, mask);
+                    } else {
+                        std::fill(mask, mask + count,
+                                  op == Opcode::NOT_EQUAL);
+                    }
+                    return true;
+                }
+                std::string_view values[kBatchSize];
+                if (!source.strings(offset, begin, count, values)) {
+                    return false;
+                }
+                compareKernel(op, values, count, std::string_view(value),
+                              mask);
+                return true;
+            } else {
+                return false;
+            }
+        },
+        constant->value);
+}
+
+void CompiledExpression::collectColumns(size_t index,
+                                        std::vector<size_t>& offsets) const {
+    const Node& node = nodes_[index];
+    switch (node.type) {
+        case NodeType::COLUMN:
+            if (std::find(offsets.begin(), offsets.end(), node.slot.offset) ==
+                offsets.end()) {
+                offsets.push_back(node.slot.offset);
+            }
+            break;
+        case NodeType::UNARY:
+            collectColumns(node.lhs, offsets);
+            break;
+        case NodeType::BINARY:
+            collectColumns(node.lhs, offsets);
+            collectColumns(node.rhs, offsets);
+            break;
+        default:
+            break;
+    }
+}
+
+}  // namespace calculator
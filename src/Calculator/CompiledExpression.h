@@ -0,0 +1,209 @@
+#ifndef DATABASE_CONTROLLER_HSE_COMPILEDEXPRESSION_H
+#define DATABASE_CONTROLLER_HSE_COMPILEDEXPRESSION_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "../types.h"
+
+namespace calculator {
+
+using Value = database::DBType;
+
+// Location of a column value: which of the evaluated rows it is read from
+// (0 for the main table, 1 for the joined one) and its offset in that row.
+// The type of the column, when known, tells the optimizer which operations
+// on it cannot fail.
+struct ColumnSlot {
+    size_t row = 0;
+    size_t offset = 0;
+    std::optional<database::DataTypeName> type;
+};
+
+using ColumnBinding = std::unordered_map<std::string, ColumnSlot>;
+
+// Smallest and largest value of a column over a block of rows; known is
+// false for columns whose values are not tracked.
+struct ColumnRange {
+    bool known = false;
+    Value min;
+    Value max;
+};
+
+// Operators are resolved to opcodes by the lexer, so evaluation dispatches on
+// an integer instead of comparing operator strings.
+enum class Opcode : uint8_t {
+    ADD,
+    SUBTRACT,
+    MULTIPLY,
+    DIVIDE,
+    MODULO,
+    AND,
+    OR,
+    XOR,
+    EQUAL,
+    NOT_EQUAL,
+    LESS,
+    LESS_EQUAL,
+    GREATER,
+    GREATER_EQUAL,
+    NEGATE,
+    NOT
+};
+
+constexpr size_t kOpcodeCount = static_cast<size_t>(Opcode::NOT) + 1;
+
+std::string opcodeToString(Opcode op);
+
+// Rows are filtered in blocks of this size (see CompiledExpression::select).
+constexpr size_t kBatchSize = 1024;
+
+using SelectionVector = std::vector<size_t>;
+
+// Column-major access to stored rows for CompiledExpression::select, so that
+// storages which do not keep RowType rows can be filtered without building
+// them. The typed accessors return the values of the column at offset for
+// rows [begin, begin + count), pointing either into the storage or into
+// buffer, or nullptr when the column does not hold values of that type.
+// count is at most kBatchSize.
+class ColumnSource {
+   public:
+    virtual ~ColumnSource() = default;
+
+    virtual const int* ints(size_t offset, size_t begin, size_t count,
+                            int* buffer) const;
+    virtual const double* doubles(size_t offset, size_t begin, size_t count,
+                                  double* buffer) const;
+    virtual const bool* bools(size_t offset, size_t begin, size_t count,
+                              bool* buffer) const;
+    // Same as above, but the values are always written to views.
+    virtual bool strings(size_t offset, size_t begin, size_t count,
+                         std::string_view* views) const;
+    // Dictionary-encoded string columns also return the codes of their
+    // values, and findCode gives the code of a string, so that equality is
+    // tested on integers. findCode returns false for strings no row has.
+    virtual const uint32_t* codes(size_t offset, size_t begin, size_t count,
+                                  uint32_t* buffer) const;
+    virtual bool findCode(size_t offset, std::string_view value,
+                          uint32_t& code) const;
+    // Evaluates column <op> constant for the rows into mask when the storage
+    // can do so without producing the values, e.g. on compressed data.
+    // Returns false to fall back to the accessors above.
+    virtual bool compare(size_t offset, Opcode op, const Value& constant,
+                         size_t begin, size_t count, uint8_t* mask) const;
+
+    // Read for the parts of a predicate that are evaluated row by row.
+    virtual Value value(size_t offset, size_t row) const = 0;
+    // The whole row when the storage keeps it as a RowType, nullptr
+    // otherwise.
+    virtual const database::RowType* storedRow(size_t row) const;
+};
+
+// Expression tree produced once by Calculator::compile. Column references are
+// resolved to row slots at compile time, so evaluation only walks the tree.
+class CompiledExpression {
+   public:
+    // PARAMETER is a '?N' placeholder: a constant whose value is supplied by
+    // bind() before evaluation, with N - 1 stored in slot.offset.
+    enum class NodeType { LITERAL, COLUMN, PARAMETER, UNARY, BINARY };
+
+    struct Node {
+        NodeType type = NodeType::LITERAL;
+        Value value;
+        ColumnSlot slot;
+        Opcode op = Opcode::ADD;
+        size_t lhs = 0;
+        size_t rhs = 0;
+    };
+
+    Value evaluate(const database::RowType& row) const;
+    Value evaluate(const database::RowType& row,
+                   const database::RowType& joinedRow) const;
+    // Same for rows stored as consecutive values, e.g. in a flat buffer.
+    Value evaluate(const Value* row, const Value* joinedRow) const;
+
+    // Appends to selection the indices (relative to rows) of the rows for
+    // which the predicate holds. Simple column <op> constant comparisons and
+    // their &&/|| combinations run as tight loops over a block of rows.
+    void select(const database::RowType* rows, size_t count,
+                SelectionVector& selection) const;
+    // Same for rows [begin, begin + count) of source; the appended indices
+    // are row numbers of the source.
+    void select(const ColumnSource& source, size_t begin, size_t count,
+                SelectionVector& selection) const;
+
+    bool empty() const { return nodes_.empty(); }
+
+    // Sets the value of every '?N' placeholder to parameters[N - 1] and
+    // optimizes the expression again with the values as constants, so that
+    // e.g. "?2 == 0 && a > ?1" can fold to false. Can be called again with
+    // other values. Throws if a placeholder has no value.
+    void bind(const std::vector<Value>& parameters);
+
+    // True when the predicate was simplified to the constant false, so no
+    // row can match and callers may skip the scan.
+    bool alwaysFalse() const;
+
+    // False when no row of a block whose columns lie in ranges (indexed by
+    // column offset) can satisfy the predicate, so the block can be skipped.
+    // Only comparisons of columns with constants and their &&/||
+    // combinations are judged; anything else may match.
+    bool mayMatch(const std::vector<ColumnRange>& ranges) const;
+
+    // Comparisons column == constant of the first row that every matching
+    // row satisfies: the root one and those joined to it by &&, as column
+    // offset and constant. Lets callers look rows up in an index.
+    std::vector<std::pair<size_t, Value>> equalities() const;
+
+   private:
+    friend class Calculator;
+
+    // Folds constant subexpressions, drops redundant && / || operands, puts
+    // columns on the left of comparisons and then reorders the operands of
+    // && and || chains by estimated cost and selectivity. Called by
+    // Calculator::compile.
+    void optimize();
+    size_t simplify(size_t index);
+    size_t foldConstant(size_t index);
+    bool isBoolean(size_t index) const;
+    size_t reorderOperands(size_t index);
+    void collectChain(size_t index, Opcode op, std::vector<size_t>& chain,
+                      std::vector<size_t>& operands) const;
+    // False only if evaluating the node cannot throw: every operation in it
+    // has operands of known types it accepts, and nothing is divided.
+    bool mayFail(size_t index) const;
+    // Alternative of Value the node evaluates to when that is known.
+    std::optional<size_t> valueType(size_t index) const;
+    double estimateCost(size_t index) const;
+    double estimateSelectivity(size_t index) const;
+
+    // Rows whose active flag is 0 do not affect the result and are skipped
+    // by the per-row evaluation; active == nullptr means all rows.
+    void evaluateMask(size_t index, const ColumnSource& source, size_t begin,
+                      size_t count, const uint8_t* active,
+                      uint8_t* mask) const;
+    bool compareColumnWithConstant(const Node& node,
+                                   const ColumnSource& source, size_t begin,
+                                   size_t count, uint8_t* mask) const;
+    void collectColumns(size_t index, std::vector<size_t>& offsets) const;
+    bool mayMatch(size_t index, const std::vector<ColumnRange>& ranges) const;
+    void collectEqualities(
+        size_t index, std::vector<std::pair<size_t, Value>>& equalities) const;
+
+    Value evaluateNode(size_t index, const Value* const rows[]) const;
+
+    std::vector<Node> nodes_;
+    size_t root_ = 0;
+    // The expression as compiled, kept for bind when it has placeholders.
+    std::vector<Node> unbound_;
+    size_t unboundRoot_ = 0;
+};
+
+}  // namespace calculator
+
+#endif  // DATABASE_CONTROLLER_HSE_COMPILEDEXPRESSION_H
@@ -9,12 +9,13 @@
 
 namespace database {
 
-void Database::createTable(const std::string& name, const SchemeType& columns) {
+void Database::createTable(const std::string& name, const SchemeType& columns,
+                           StorageType storage) {
     if (tables_.find(name) != tables_.end()) {
         throw std::runtime_error("Table already exists: " + name);
     }
 
-    Table table(name, columns);
+    Table table(name, columns, storage);
 
     for (const auto& column : columns) {
         if (column.isUnique) {
@@ -23,6 +24,7 @@ void Database::createTable(const std::string& name, const SchemeType& columns) {
     }
 
     tables_.emplace(name, std::move(table));
+    ++catalogVersion_;
 }
 
 void Database::insertInto(const std::string& tableName, const RowType& values) {
@@ -33,6 +35,15 @@ void Database::insertInto(const std::string& tableName, const RowType& values) {
     it->second.insert_row(values);
 }
 
+void Database::insertRows(const std::string& tableName,
+                          std::vector<RowType> rows) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        throw std::runtime_error("Table does not exist: " + tableName);
+    }
+    it->second.insert_rows(std::move(rows));
+}
+
 Table& Database::getTable(const std::string& name) {
     auto it = tables_.find(name);
     if (it == tables_.end()) {
@@ -41,6 +52,14 @@ Table& Database::getTable(const std::string& name) {
     return it->second;
 }
 
+size_t Database::catalogVersion() const {
+    size_t version = catalogVersion_;
+    for (const auto& [name, table] : tables_) {
+        version += table.scheme_version();
+    }
+    return version;
+}
+
 bool Database::hasTable(const std::string& name) const {
     return tables_.find(name) != tables_.end();
 }
@@ -51,5 +70,6 @@ void Database::createIndex(const std::string& tableName, const std::string& inde
         throw std::runtime_error("Таблица не существует: " + tableName);
     }
     it->second.createIndex(indexType, columns);
+    ++catalogVersion_;
 }
 }  // namespace database
\ No newline at end of file
@@ -15,13 +15,21 @@ namespace database {
 
 class Database {
    public:
-    void createTable(const std::string& name, const SchemeType& columns);
+    void createTable(const std::string& name, const SchemeType& columns,
+                     StorageType storage = StorageType::ROW);
     void insertInto(const std::string& tableName, const RowType& values);
+    void insertRows(const std::string& tableName, std::vector<RowType> rows);
     Table& getTable(const std::string& name);
     bool hasTable(const std::string& name) const;
     void createIndex(const std::string& tableName, const std::string& indexType, const std::vector<std::string>& columns);
+
+    // Grows whenever a table, an index or a constraint is added, also
+    // through Table methods, so that compiled statements can tell that the
+    // scheme they were built for changed.
+    size_t catalogVersion() const;
    private:
     std::unordered_map<std::string, Table> tables_;
+    size_t catalogVersion_ = 0;
 };
 
 }  // namespace database
@@ -24,8 +24,31 @@ TEST_F(DatabaseTest, InsertIntoTable) {
                    {{"ID", DataTypeName::INT}, {"Name", DataTypeName::STRING}});
     db.insertInto("Test", {1, "Alice"});
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 1);
     EXPECT_EQ(std::get<int>(data[0][0]), 1);
     EXPECT_EQ(std::get<std::string>(data[0][1]), "Alice");
-}
\ No newline at end of file
+}
+
+TEST_F(DatabaseTest, CatalogVersion) {
+    size_t version = db.catalogVersion();
+    db.createTable("Test",
+                   {{"ID", DataTypeName::INT}, {"Name", DataTypeName::STRING}});
+    EXPECT_GT(db.catalogVersion(), version);
+
+    version = db.catalogVersion();
+    db.insertInto("Test", {1, "Alice"});
+    EXPECT_EQ(db.catalogVersion(), version);
+
+    db.createIndex("Test", "ordered", {"ID"});
+    EXPECT_GT(db.catalogVersion(), version);
+
+    // constraints added on the table itself count as well
+    for (const auto& change : {&Table::addUniqueConstraint,
+                               &Table::addKeyConstraint,
+                               &Table::addAutoIncrement}) {
+        version = db.catalogVersion();
+        (db.getTable("Test").*change)("ID");
+        EXPECT_GT(db.catalogVersion(), version);
+    }
+}
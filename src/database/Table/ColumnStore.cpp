@@ -0,0 +1,291 @@
+#include "ColumnStore.h"
+
+#include <stdexcept>
+#include <type_traits>
+
+namespace database {
+
+namespace {
+
+ColumnData makeColumn(const ColumnDefinition& column) {
+    if (column.isDictionary) {
+        return std::vector<uint32_t>();
+    }
+    switch (column.type) {
+        case DataTypeName::INT:
+        case DataTypeName::BOOL:
+            return IntColumn();
+        case DataTypeName::DOUBLE:
+            return std::vector<double>();
+        case DataTypeName::STRING:
+            return std::vector<std::string>();
+        case DataTypeName::BYTEBUFFER:
+            return std::vector<bytebuffer>();
+    }
+    throw std::runtime_error("Unknown column type.");
+}
+
+int toInt(const DBType& value) {
+    return std::holds_alternative<bool>(value) ? std::get<bool>(value)
+                                               : std::get<int>(value);
+}
+
+}  // namespace
+
+ColumnStore::ColumnStore(const SchemeType& scheme) : Storage(scheme) {
+    columns_.reserve(scheme.size());
+    for (const auto& column : scheme) {
+        columns_.push_back(makeColumn(column));
+    }
+}
+
+void ColumnStore::append(const RowType& row) {
+    validate(row);
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        push(i, row[i]);
+    }
+    ++size_;
+    extendZoneMap(size_ - 1, row);
+}
+
+void ColumnStore::reserve(size_t size) {
+    for (auto& column : columns_) {
+        std::visit([size](auto& values) { values.reserve(size); }, column);
+    }
+}
+
+RowType ColumnStore::row(size_t index) const {
+    RowType row;
+    row.reserve(columns_.size());
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        row.push_back(value(i, index));
+    }
+    return row;
+}
+
+void ColumnStore::setRow(size_t index, const RowType& row) {
+    validate(row);
+    for (size_t i = 0; i < columns_.size(); ++i) {
+        set(i, index, row[i]);
+    }
+    extendZoneMap(index, row);
+}
+
+void ColumnStore::flush() {
+    for (auto& column : columns_) {
+        if (auto* values = std::get_if<IntColumn>(&column)) {
+            values->compress();
+        }
+    }
+}
+
+void ColumnStore::erase(const std::vector<size_t>& rows) {
+    if (rows.empty()) {
+        return;
+    }
+    for (auto& column : columns_) {
+        std::visit(
+            [&rows](auto& values) {
+                using T = std::decay_t<decltype(values)>;
+                if constexpr (std::is_same_v<T, IntColumn>) {
+                    values.erase(rows);
+                } else {
+                    size_t next = 0;
+                    size_t kept = 0;
+                    for (size_t row = 0; row < values.size(); ++row) {
+                        if (next < rows.size() && rows[next] == row) {
+                            ++next;
+                            continue;
+                        }
+                        if (kept != row) {
+                            values[kept] = std::move(values[row]);
+                        }
+                        ++kept;
+                    }
+                    values.resize(kept);
+                }
+            },
+            column);
+    }
+    size_ -= rows.size();
+    rebuildZoneMaps();
+}
+
+void ColumnStore::clear() {
+    for (auto& column : columns_) {
+        std::visit(
+            [](auto& values) { values = std::decay_t<decltype(values)>(); },
+            column);
+    }
+    for (auto& dictionary : dictionaries_) {
+        dictionary = {};
+    }
+    size_ = 0;
+    zoneMaps_.clear();
+}
+
+size_t ColumnStore::memoryUsage() const {
+    size_t bytes = sharedMemoryUsage();
+    for (const auto& column : columns_) {
+        bytes += std::visit(
+            [](const auto& values) -> size_t {
+                using T = std::decay_t<decltype(values)>;
+                if constexpr (std::is_same_v<T, IntColumn>) {
+                    return values.memoryUsage();
+                } else {
+                    using Value = typename T::value_type;
+                    size_t used = values.capacity() * sizeof(Value);
+                    if constexpr (std::is_same_v<Value, std::string>) {
+                        for (const auto& value : values) {
+                            used += database::memoryUsage(value) -
+                                    sizeof(std::string);
+                        }
+                    } else if constexpr (std::is_same_v<Value, bytebuffer>) {
+                        for (const auto& value : values) {
+                            used += value.capacity();
+                        }
+                    }
+                    return used;
+                }
+            },
+            column);
+    }
+    return bytes;
+}
+
+const int* ColumnStore::ints(size_t offset, size_t begin, size_t count,
+                             int* buffer) const {
+    const IntColumn* values = intColumn(offset);
+    if (values == nullptr || scheme_[offset].type != DataTypeName::INT) {
+        return nullptr;
+    }
+    return values->read(begin, count, buffer);
+}
+
+const double* ColumnStore::doubles(size_t offset, size_t begin, size_t,
+                                   double*) const {
+    const auto* values = std::get_if<std::vector<double>>(&columns_[offset]);
+    return values == nullptr ? nullptr : values->data() + begin;
+}
+
+const bool* ColumnStore::bools(size_t offset, size_t begin, size_t count,
+                               bool* buffer) const {
+    const IntColumn* values = intColumn(offset);
+    if (values == nullptr || scheme_[offset].type != DataTypeName::BOOL) {
+        return nullptr;
+    }
+    int bits[calculator::kBatchSize];
+    const int* read = values->read(begin, count, bits);
+    for (size_t i = 0; i < count; ++i) {
+        buffer[i] = read[i] != 0;
+    }
+    return buffer;
+}
+
+bool ColumnStore::strings(size_t offset, size_t begin, size_t count,
+                          std::string_view* views) const {
+    if (const auto* codes =
+            std::get_if<std::vector<uint32_t>>(&columns_[offset])) {
+        for (size_t i = 0; i < count; ++i) {
+            views[i] = dictionaries_[offset].decode((*codes)[begin + i]);
+        }
+        return true;
+    }
+    const auto* values =
+        std::get_if<std::vector<std::string>>(&columns_[offset]);
+    if (values == nullptr) {
+        return false;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        views[i] = (*values)[begin + i];
+    }
+    return true;
+}
+
+const uint32_t* ColumnStore::codes(size_t offset, size_t begin, size_t,
+                                   uint32_t*) const {
+    const auto* codes = std::get_if<std::vector<uint32_t>>(&columns_[offset]);
+    return codes == nullptr ? nullptr : codes->data() + begin;
+}
+
+bool ColumnStore::compare(size_t offset, calculator::Opcode op,
+                          const DBType& constant, size_t begin, size_t count,
+                          uint8_t* mask) const {
+    const IntColumn* values = intColumn(offset);
+    if (values == nullptr) {
+        return false;
+    }
+    if (scheme_[offset].type == DataTypeName::INT &&
+        std::holds_alternative<int>(constant)) {
+        return values->compare(op, std::get<int>(constant), begin, count,
+                               mask);
+    }
+    if (scheme_[offset].type == DataTypeName::BOOL &&
+        std::holds_alternative<bool>(constant) &&
+        (op == calculator::Opcode::EQUAL ||
+         op == calculator::Opcode::NOT_EQUAL)) {
+        return values->compare(op, std::get<bool>(constant), begin, count,
+                               mask);
+    }
+    return false;
+}
+
+DBType ColumnStore::value(size_t offset, size_t row) const {
+    return std::visit(
+        [&](const auto& values) -> DBType {
+            using T = std::decay_t<decltype(values)>;
+            if constexpr (std::is_same_v<T, IntColumn>) {
+                if (scheme_[offset].type == DataTypeName::BOOL) {
+                    return values.get(row) != 0;
+                }
+                return values.get(row);
+            } else if constexpr (std::is_same_v<T, std::vector<uint32_t>>) {
+                return dictionaries_[offset].decode(values[row]);
+            } else {
+                return values[row];
+            }
+        },
+        columns_[offset]);
+}
+
+void ColumnStore::push(size_t offset, const DBType& value) {
+    std::visit(
+        [&](auto& values) {
+            using T = std::decay_t<decltype(values)>;
+            if constexpr (std::is_same_v<T, IntColumn>) {
+                values.push_back(toInt(value));
+            } else if constexpr (std::is_same_v<T, std::vector<uint32_t>>) {
+                values.push_back(
+                    dictionaries_[offset].encode(std::get<std::string>(value)));
+            } else if constexpr (std::is_same_v<T, std::vector<double>>) {
+                values.push_back(std::holds_alternative<int>(value)
+                                     ? std::get<int>(value)
+                                     : std::get<double>(value));
+            } else {
+                values.push_back(std::get<typename T::value_type>(value));
+            }
+        },
+        columns_[offset]);
+}
+
+void ColumnStore::set(size_t offset, size_t row, const DBType& value) {
+    std::visit(
+        [&](auto& values) {
+            using T = std::decay_t<decltype(values)>;
+            if constexpr (std::is_same_v<T, IntColumn>) {
+                values.set(row, toInt(value));
+            } else if constexpr (std::is_same_v<T, std::vector<uint32_t>>) {
+                values[row] =
+                    dictionaries_[offset].encode(std::get<std::string>(value));
+            } else if constexpr (std::is_same_v<T, std::vector<double>>) {
+                values[row] = std::holds_alternative<int>(value)
+                                  ? std::get<int>(value)
+                                  : std::get<double>(value);
+            } else {
+                values[row] = std::get<typename T::value_type>(value);
+            }
+        },
+        columns_[offset]);
+}
+
+}  // namespace database
@@ -0,0 +1,68 @@
+#ifndef DATABASE_CONTROLLER_HSE_COLUMNSTORE_H
+#define DATABASE_CONTROLLER_HSE_COLUMNSTORE_H
+
+#include <cstdint>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "../../types.h"
+#include "IntColumn.h"
+#include "Storage.h"
+
+namespace database {
+
+// Values of one column, in the alternative matching its DataTypeName. INT
+// and BOOL columns are compressed IntColumns; dictionary-encoded VARCHAR
+// columns keep codes.
+using ColumnData =
+    std::variant<IntColumn, std::vector<double>, std::vector<std::string>,
+                 std::vector<bytebuffer>, std::vector<uint32_t>>;
+
+// Storage of a COLUMNAR table: one contiguous typed array per column, so a
+// compiled predicate reads only the columns it refers to.
+class ColumnStore : public Storage {
+   public:
+    ColumnStore() = default;
+    explicit ColumnStore(const SchemeType& scheme);
+
+    void append(const RowType& row) override;
+    void reserve(size_t size) override;
+
+    RowType row(size_t index) const override;
+    void setRow(size_t index, const RowType& row) override;
+
+    void erase(const std::vector<size_t>& rows) override;
+    void clear() override;
+    void flush() override;
+    size_t memoryUsage() const override;
+
+    const int* ints(size_t offset, size_t begin, size_t count,
+                    int* buffer) const override;
+    const double* doubles(size_t offset, size_t begin, size_t count,
+                          double* buffer) const override;
+    const bool* bools(size_t offset, size_t begin, size_t count,
+                      bool* buffer) const override;
+    bool strings(size_t offset, size_t begin, size_t count,
+                 std::string_view* views) const override;
+    const uint32_t* codes(size_t offset, size_t begin, size_t count,
+                          uint32_t* buffer) const override;
+    bool compare(size_t offset, calculator::Opcode op, const DBType& constant,
+                 size_t begin, size_t count, uint8_t* mask) const override;
+    DBType value(size_t offset, size_t row) const override;
+
+    // nullptr unless the column is INT or BOOL
+    const IntColumn* intColumn(size_t offset) const {
+        return std::get_if<IntColumn>(&columns_[offset]);
+    }
+
+   private:
+    void push(size_t offset, const DBType& value);
+    void set(size_t offset, size_t row, const DBType& value);
+
+    std::vector<ColumnData> columns_;
+};
+
+}  // namespace database
+
+#endif  // DATABASE_CONTROLLER_HSE_COLUMNSTORE_H
@@ -0,0 +1,38 @@
+#include "Dictionary.h"
+
+#include "../../types.h"
+
+namespace database {
+
+uint32_t Dictionary::encode(std::string_view value) {
+    auto it = codes_.find(value);
+    if (it != codes_.end()) {
+        return it->second;
+    }
+    auto code = static_cast<uint32_t>(values_.size());
+    codes_.emplace(std::string(value), code);
+    values_.emplace_back(value);
+    return code;
+}
+
+bool Dictionary::find(std::string_view value, uint32_t& code) const {
+    auto it = codes_.find(value);
+    if (it == codes_.end()) {
+        return false;
+    }
+    code = it->second;
+    return true;
+}
+
+size_t Dictionary::memoryUsage() const {
+    size_t bytes = (values_.capacity() - values_.size()) * sizeof(std::string) +
+                   codes_.bucket_count() * sizeof(void*);
+    for (const auto& value : values_) {
+        // the value is kept twice: in values_ and as the key of codes_
+        bytes += 2 * database::memoryUsage(value) + 2 * sizeof(void*) +
+                 sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+}  // namespace database
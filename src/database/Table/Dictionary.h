@@ -0,0 +1,43 @@
+#ifndef DATABASE_CONTROLLER_HSE_DICTIONARY_H
+#define DATABASE_CONTROLLER_HSE_DICTIONARY_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace database {
+
+// Distinct values of a dictionary-encoded VARCHAR column, which stores the
+// code of each row's value instead of the string. Codes are assigned in
+// order of first appearance and are never reused.
+class Dictionary {
+   public:
+    uint32_t encode(std::string_view value);
+    // False when no row ever had this value.
+    bool find(std::string_view value, uint32_t& code) const;
+    const std::string& decode(uint32_t code) const { return values_[code]; }
+
+    size_t size() const { return values_.size(); }
+    // Approximate bytes taken by the values and the lookup table.
+    size_t memoryUsage() const;
+
+   private:
+    // Lets codes_ be searched with a std::string_view, without building a
+    // std::string for every lookup.
+    struct Hash {
+        using is_transparent = void;
+        size_t operator()(std::string_view value) const {
+            return std::hash<std::string_view>{}(value);
+        }
+    };
+
+    std::vector<std::string> values_;
+    std::unordered_map<std::string, uint32_t, Hash, std::equal_to<>> codes_;
+};
+
+}  // namespace database
+
+#endif  // DATABASE_CONTROLLER_HSE_DICTIONARY_H
@@ -0,0 +1,445 @@
+#include "IntColumn.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <limits>
+
+namespace database {
+
+using calculator::Opcode;
+
+namespace {
+
+size_t packedWords(size_t count, uint8_t width) {
+    return (count * width + 63) / 64;
+}
+
+void pack(std::vector<uint64_t>& bits, uint8_t width, size_t index,
+          uint64_t value) {
+    if (width == 0) {
+        return;
+    }
+    size_t position = index * width;
+    size_t word = position / 64;
+    size_t shift = position % 64;
+    bits[word] |= value << shift;
+    if (shift + width > 64) {
+        bits[word + 1] |= value >> (64 - shift);
+    }
+}
+
+uint64_t unpack(const std::vector<uint64_t>& bits, uint8_t width,
+                size_t index) {
+    if (width == 0) {
+        return 0;
+    }
+    size_t position = index * width;
+    size_t word = position / 64;
+    size_t shift = position % 64;
+    uint64_t value = bits[word] >> shift;
+    if (shift + width > 64) {
+        value |= bits[word + 1] << (64 - shift);
+    }
+    return value & ((uint64_t{1} << width) - 1);
+}
+
+bool isComparison(Opcode op) {
+    switch (op) {
+        case Opcode::EQUAL:
+        case Opcode::NOT_EQUAL:
+        case Opcode::LESS:
+        case Opcode::LESS_EQUAL:
+        case Opcode::GREATER:
+        case Opcode::GREATER_EQUAL:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool test(Opcode op, int64_t value, int64_t constant) {
+    switch (op) {
+        case Opcode::EQUAL:
+            return value == constant;
+        case Opcode::NOT_EQUAL:
+            return value != constant;
+        case Opcode::LESS:
+            return value < constant;
+        case Opcode::LESS_EQUAL:
+            return value <= constant;
+        case Opcode::GREATER:
+            return value > constant;
+        default:
+            return value >= constant;
+    }
+}
+
+// One loop per operator, so that the comparison is not dispatched per value.
+template <typename Value>
+void compareValues(Opcode op, size_t count, int64_t constant, uint8_t* mask,
+                   Value value) {
+    switch (op) {
+        case Opcode::EQUAL:
+            for (size_t i = 0; i < count; ++i) {
+                mask[i] = value(i) == constant;
+            }
+            break;
+        case Opcode::NOT_EQUAL:
+            for (size_t i = 0; i < count; ++i) {
+                mask[i] = value(i) != constant;
+            }
+            break;
+        case Opcode::LESS:
+            for (size_t i = 0; i < count; ++i) {
+                mask[i] = value(i) < constant;
+            }
+            break;
+        case Opcode::LESS_EQUAL:
+            for (size_t i = 0; i < count; ++i) {
+                mask[i] = value(i) <= constant;
+            }
+            break;
+        case Opcode::GREATER:
+            for (size_t i = 0; i < count; ++i) {
+                mask[i] = value(i) > constant;
+            }
+            break;
+        default:
+            for (size_t i = 0; i < count; ++i) {
+                mask[i] = value(i) >= constant;
+            }
+            break;
+    }
+}
+
+}  // namespace
+
+int IntColumn::get(size_t row) const {
+    return get(segments_[row / kSegmentSize], row % kSegmentSize);
+}
+
+void IntColumn::set(size_t row, int value) {
+    Segment& segment = segments_[row / kSegmentSize];
+    size_t index = row % kSegmentSize;
+    if (segment.encoding != Encoding::PLAIN) {
+        if (get(segment, index) == value) {
+            return;
+        }
+        Segment plain;
+        plain.plain = plainValues(segment);
+        plain.size = segment.size;
+        segment = std::move(plain);
+    }
+    segment.plain[index] = value;
+}
+
+void IntColumn::push_back(int value) {
+    if (segments_.empty() || segments_.back().size == kSegmentSize) {
+        segments_.emplace_back();
+        segments_.back().plain.reserve(kSegmentSize);
+    }
+    Segment& segment = segments_.back();
+    segment.plain.push_back(value);
+    ++segment.size;
+    ++size_;
+    if (segment.size == kSegmentSize) {
+        segment = encode(segment.plain);
+    }
+}
+
+void IntColumn::erase(const std::vector<size_t>& rows) {
+    if (rows.empty()) {
+        return;
+    }
+    std::vector<int> values;
+    values.reserve(size_);
+    for (const auto& segment : segments_) {
+        std::vector<int> part = plainValues(segment);
+        values.insert(values.end(), part.begin(), part.end());
+    }
+    size_t next = 0;
+    size_t kept = 0;
+    for (size_t row = 0; row < values.size(); ++row) {
+        if (next < rows.size() && rows[next] == row) {
+            ++next;
+            continue;
+        }
+        values[kept++] = values[row];
+    }
+    values.resize(kept);
+    clear();
+    for (int value : values) {
+        push_back(value);
+    }
+}
+
+void IntColumn::clear() {
+    segments_ = std::vector<Segment>();
+    size_ = 0;
+}
+
+void IntColumn::compress() {
+    for (auto& segment : segments_) {
+        if (segment.encoding == Encoding::PLAIN &&
+            segment.size == kSegmentSize) {
+            segment = encode(segment.plain);
+        }
+    }
+}
+
+const int* IntColumn::read(size_t begin, size_t count, int* buffer) const {
+    if (count == 0) {
+        return buffer;
+    }
+    const Segment& first = segments_[begin / kSegmentSize];
+    if (first.encoding == Encoding::PLAIN &&
+        begin / kSegmentSize == (begin + count - 1) / kSegmentSize) {
+        return first.plain.data() + begin % kSegmentSize;
+    }
+    for (size_t row = begin; row < begin + count;) {
+        const Segment& segment = segments_[row / kSegmentSize];
+        size_t index = row % kSegmentSize;
+        size_t length = std::min(segment.size - index, begin + count - row);
+        decode(segment, index, length, buffer + (row - begin));
+        row += length;
+    }
+    return buffer;
+}
+
+bool IntColumn::compare(Opcode op, int constant, size_t begin, size_t count,
+                        uint8_t* mask) const {
+    if (!isComparison(op)) {
+        return false;
+    }
+    for (size_t row = begin; row < begin + count;) {
+        const Segment& segment = segments_[row / kSegmentSize];
+        size_t index = row % kSegmentSize;
+        size_t length = std::min(segment.size - index, begin + count - row);
+        uint8_t* out = mask + (row - begin);
+        row += length;
+
+        if (segment.encoding == Encoding::PLAIN) {
+            const int* values = segment.plain.data() + index;
+            compareValues(op, length, constant, out,
+                          [values](size_t i) { return values[i]; });
+            continue;
+        }
+
+        // EQUAL and NOT_EQUAL are decided when the constant is out of the
+        // segment range or the segment holds a single value; the other
+        // operators are monotone, so they are decided when they give the
+        // same result at both ends of the range.
+        bool atMin = test(op, segment.min, constant);
+        bool atMax = test(op, segment.max, constant);
+        bool decided = atMin == atMax;
+        if (op == Opcode::EQUAL || op == Opcode::NOT_EQUAL) {
+            decided = segment.min == segment.max || constant < segment.min ||
+                      constant > segment.max;
+            atMin = op == Opcode::NOT_EQUAL;
+            if (segment.min == segment.max) {
+                atMin = test(op, segment.min, constant);
+            }
+        }
+        if (decided) {
+            std::fill(out, out + length, atMin);
+            continue;
+        }
+
+        switch (segment.encoding) {
+            case Encoding::RLE: {
+                auto run = std::upper_bound(segment.runEnds.begin(),
+                                            segment.runEnds.end(), index);
+                for (size_t i = index; i < index + length; ++run) {
+                    size_t end = std::min<size_t>(*run, index + length);
+                    bool result = test(
+                        op, segment.runValues[run - segment.runEnds.begin()],
+                        constant);
+                    std::fill(out + (i - index), out + (end - index), result);
+                    i = end;
+                }
+                break;
+            }
+            case Encoding::BITPACKED:
+                compareValues(op, length, constant - segment.base, out,
+                              [&segment, index](size_t i) {
+                                  return static_cast<int64_t>(unpack(
+                                      segment.bits, segment.width, index + i));
+                              });
+                break;
+            default: {
+                int values[calculator::kBatchSize];
+                for (size_t i = 0; i < length; i += calculator::kBatchSize) {
+                    size_t part = std::min(length - i, calculator::kBatchSize);
+                    decode(segment, index + i, part, values);
+                    compareValues(op, part, constant, out + i,
+                                  [&values](size_t j) { return values[j]; });
+                }
+                break;
+            }
+        }
+    }
+    return true;
+}
+
+size_t IntColumn::memoryUsage() const {
+    size_t bytes = 0;
+    for (const auto& segment : segments_) {
+        bytes += segment.plain.size() * sizeof(int) +
+                 segment.runValues.size() * sizeof(int) +
+                 segment.runEnds.size() * sizeof(uint32_t) +
+                 segment.bits.size() * sizeof(uint64_t) +
+                 segment.checkpoints.size() * sizeof(int);
+    }
+    return bytes;
+}
+
+IntColumn::Segment IntColumn::encode(const std::vector<int>& values) {
+    Segment segment;
+    segment.size = values.size();
+    auto [min, max] = std::minmax_element(values.begin(), values.end());
+    segment.min = *min;
+    segment.max = *max;
+
+    size_t runs = 1;
+    int64_t minDelta = std::numeric_limits<int64_t>::max();
+    int64_t maxDelta = std::numeric_limits<int64_t>::min();
+    for (size_t i = 1; i < values.size(); ++i) {
+        runs += values[i] != values[i - 1];
+        int64_t delta = int64_t{values[i]} - values[i - 1];
+        minDelta = std::min(minDelta, delta);
+        maxDelta = std::max(maxDelta, delta);
+    }
+    if (values.size() < 2) {
+        minDelta = maxDelta = 0;
+    }
+
+    auto packedWidth = [](int64_t range) {
+        return static_cast<uint8_t>(
+            std::bit_width(static_cast<uint64_t>(range)));
+    };
+    uint8_t valueWidth = packedWidth(int64_t{segment.max} - segment.min);
+    uint8_t deltaWidth = packedWidth(maxDelta - minDelta);
+
+    size_t plainBytes = values.size() * sizeof(int);
+    size_t packedBytes = packedWords(values.size(), valueWidth) * 8;
+    size_t deltaBytes = std::numeric_limits<size_t>::max();
+    if (deltaWidth <= 32) {
+        deltaBytes = packedWords(values.size() - 1, deltaWidth) * 8;
+        if (deltaWidth > 0) {
+            deltaBytes +=
+                (values.size() + kCheckpoint - 1) / kCheckpoint * sizeof(int);
+        }
+    }
+    size_t runBytes = runs * (sizeof(int) + sizeof(uint32_t));
+
+    size_t best = std::min({plainBytes, packedBytes, deltaBytes, runBytes});
+    if (best == plainBytes) {
+        segment.plain = values;
+    } else if (best == packedBytes) {
+        segment.encoding = Encoding::BITPACKED;
+        segment.base = segment.min;
+        segment.width = valueWidth;
+        segment.bits.resize(packedWords(values.size(), valueWidth));
+        for (size_t i = 0; i < values.size(); ++i) {
+            pack(segment.bits, valueWidth, i,
+                 static_cast<uint64_t>(int64_t{values[i]} - segment.min));
+        }
+    } else if (best == deltaBytes) {
+        segment.encoding = Encoding::DELTA;
+        segment.first = values.front();
+        segment.base = minDelta;
+        segment.width = deltaWidth;
+        segment.bits.resize(packedWords(values.size() - 1, deltaWidth));
+        for (size_t i = 1; i < values.size(); ++i) {
+            pack(segment.bits, deltaWidth, i - 1,
+                 static_cast<uint64_t>(int64_t{values[i]} - values[i - 1] -
+                                       minDelta));
+        }
+        if (deltaWidth > 0) {
+            for (size_t i = 0; i < values.size(); i += kCheckpoint) {
+                segment.checkpoints.push_back(values[i]);
+            }
+        }
+    } else {
+        segment.encoding = Encoding::RLE;
+        segment.runValues.reserve(runs);
+        segment.runEnds.reserve(runs);
+        for (size_t i = 0; i < values.size(); ++i) {
+            if (i + 1 == values.size() || values[i + 1] != values[i]) {
+                segment.runValues.push_back(values[i]);
+                segment.runEnds.push_back(static_cast<uint32_t>(i + 1));
+            }
+        }
+    }
+    return segment;
+}
+
+void IntColumn::decode(const Segment& segment, size_t begin, size_t count,
+                       int* out) {
+    switch (segment.encoding) {
+        case Encoding::PLAIN:
+            std::memcpy(out, segment.plain.data() + begin,
+                        count * sizeof(int));
+            break;
+        case Encoding::RLE: {
+            auto run = std::upper_bound(segment.runEnds.begin(),
+                                        segment.runEnds.end(), begin);
+            for (size_t i = 0; i < count; ++i) {
+                if (begin + i >= *run) {
+                    ++run;
+                }
+                out[i] = segment.runValues[run - segment.runEnds.begin()];
+            }
+            break;
+        }
+        case Encoding::DELTA: {
+            if (segment.width == 0) {
+                for (size_t i = 0; i < count; ++i) {
+                    out[i] = static_cast<int>(
+                        segment.first +
+                        static_cast<int64_t>(begin + i) * segment.base);
+                }
+                break;
+            }
+            size_t index = begin / kCheckpoint * kCheckpoint;
+            int64_t value = segment.checkpoints[begin / kCheckpoint];
+            for (; index < begin; ++index) {
+                value += segment.base +
+                         static_cast<int64_t>(
+                             unpack(segment.bits, segment.width, index));
+            }
+            for (size_t i = 0; i < count; ++i) {
+                if (i > 0) {
+                    value += segment.base +
+                             static_cast<int64_t>(unpack(
+                                 segment.bits, segment.width, begin + i - 1));
+                }
+                out[i] = static_cast<int>(value);
+            }
+            break;
+        }
+        case Encoding::BITPACKED:
+            for (size_t i = 0; i < count; ++i) {
+                uint64_t packed =
+                    unpack(segment.bits, segment.width, begin + i);
+                out[i] = static_cast<int>(segment.base +
+                                          static_cast<int64_t>(packed));
+            }
+            break;
+    }
+}
+
+int IntColumn::get(const Segment& segment, size_t index) {
+    int value;
+    decode(segment, index, 1, &value);
+    return value;
+}
+
+std::vector<int> IntColumn::plainValues(const Segment& segment) {
+    std::vector<int> values(segment.size);
+    decode(segment, 0, segment.size, values.data());
+    return values;
+}
+
+}  // namespace database
@@ -0,0 +1,88 @@
+#ifndef DATABASE_CONTROLLER_HSE_INTCOLUMN_H
+#define DATABASE_CONTROLLER_HSE_INTCOLUMN_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../../Calculator/CompiledExpression.h"
+
+namespace database {
+
+// Values of an INT or BOOL column of a COLUMNAR table, split into segments of
+// kSegmentSize values. A segment is compressed when it fills up, with
+// whichever of run-length, delta or frame-of-reference bit-packing takes the
+// least space for its values; the last segment is kept plain.
+class IntColumn {
+   public:
+    static constexpr size_t kSegmentSize = 4 * calculator::kBatchSize;
+
+    enum class Encoding : uint8_t { PLAIN, RLE, DELTA, BITPACKED };
+
+    size_t size() const { return size_; }
+
+    int get(size_t row) const;
+    // A compressed segment is decompressed to be changed and stays plain
+    // until compress() is called.
+    void set(size_t row, int value);
+    void push_back(int value);
+    void reserve(size_t) {}
+
+    // Removes the rows listed in ascending order in rows.
+    void erase(const std::vector<size_t>& rows);
+    void clear();
+
+    // Compresses the full segments that are plain.
+    void compress();
+
+    // Values of rows [begin, begin + count), pointing into a plain segment
+    // or written to buffer.
+    const int* read(size_t begin, size_t count, int* buffer) const;
+    // Evaluates value <op> constant for rows [begin, begin + count) into
+    // mask. Segments whose minimum and maximum decide the result are not
+    // decoded, runs are compared once and bit-packed values are compared
+    // against the constant shifted by the segment base. Returns false if op
+    // is not a comparison.
+    bool compare(calculator::Opcode op, int constant, size_t begin,
+                 size_t count, uint8_t* mask) const;
+
+    Encoding encoding(size_t segment) const {
+        return segments_[segment].encoding;
+    }
+    // Bytes taken by the values, for tests and statistics.
+    size_t memoryUsage() const;
+
+   private:
+    struct Segment {
+        Encoding encoding = Encoding::PLAIN;
+        size_t size = 0;
+        int min = 0;
+        int max = 0;
+        std::vector<int> plain;
+        // RLE: value of each run and the index just past it
+        std::vector<int> runValues;
+        std::vector<uint32_t> runEnds;
+        // DELTA: value i is value i - 1 plus base plus packed value i - 1,
+        // with the absolute value of every kCheckpoint-th row in
+        // checkpoints. BITPACKED: value i is base plus packed value i.
+        int first = 0;
+        int64_t base = 0;
+        uint8_t width = 0;
+        std::vector<uint64_t> bits;
+        std::vector<int> checkpoints;
+    };
+
+    static constexpr size_t kCheckpoint = 64;
+
+    static Segment encode(const std::vector<int>& values);
+    static void decode(const Segment& segment, size_t begin, size_t count,
+                       int* out);
+    static int get(const Segment& segment, size_t index);
+    static std::vector<int> plainValues(const Segment& segment);
+
+    std::vector<Segment> segments_;
+    size_t size_ = 0;
+};
+
+}  // namespace database
+
+#endif  // DATABASE_CONTROLLER_HSE_INTCOLUMN_H
@@ -0,0 +1,318 @@
+#include "OrderedIndex.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace database {
+
+namespace {
+
+// Type tags; 0xff is left for prefixEnd.
+enum KeyTag : char { INT_KEY = 1, DOUBLE_KEY, BOOL_KEY, STRING_KEY, BYTES_KEY };
+
+void appendBigEndian(std::string& key, uint64_t value, size_t bytes) {
+    for (size_t i = bytes; i-- > 0;) {
+        key.push_back(static_cast<char>(value >> (8 * i)));
+    }
+}
+
+// Bytes with every zero escaped as 0x00 0xff and closed by 0x00 0x00, so
+// that a shorter value sorts first and is not a prefix of a longer one.
+void appendBytes(std::string& key, const char* data, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        key.push_back(data[i]);
+        if (data[i] == '\0') {
+            key.push_back('\xff');
+        }
+    }
+    key.append(2, '\0');
+}
+
+// Number of entries of keys and rows that are less than (key, row), or not
+// greater than it when upper is set.
+size_t entryBound(const std::vector<std::string>& keys,
+                  const std::vector<size_t>& rows, const std::string& key,
+                  size_t row, bool upper) {
+    size_t low = 0;
+    size_t high = keys.size();
+    while (low < high) {
+        size_t middle = (low + high) / 2;
+        int order = keys[middle].compare(key);
+        bool before = upper ? rows[middle] <= row : rows[middle] < row;
+        if (order < 0 || (order == 0 && before)) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    return low;
+}
+
+size_t keyBound(const std::vector<std::string>& keys, const std::string& key,
+                bool upper) {
+    auto it = upper ? std::upper_bound(keys.begin(), keys.end(), key)
+                    : std::lower_bound(keys.begin(), keys.end(), key);
+    return it - keys.begin();
+}
+
+size_t keysMemoryUsage(const std::vector<std::string>& keys) {
+    size_t bytes = keys.capacity() * sizeof(std::string);
+    for (const auto& key : keys) {
+        bytes += memoryUsage(key) - sizeof(std::string);
+    }
+    return bytes;
+}
+
+}  // namespace
+
+void OrderedIndex::appendKey(std::string& key, const DBType& value) {
+    std::visit(
+        [&key](const auto& value) {
+            using T = std::decay_t<decltype(value)>;
+            if constexpr (std::is_same_v<T, int>) {
+                key.push_back(INT_KEY);
+                appendBigEndian(key, static_cast<uint32_t>(value) ^ 0x80000000u,
+                                4);
+            } else if constexpr (std::is_same_v<T, double>) {
+                // negative values have every bit flipped, positive ones only
+                // the sign, so that the bits order like the values
+                uint64_t bits = std::bit_cast<uint64_t>(value == 0.0 ? 0.0
+                                                                     : value);
+                bits = (bits >> 63) ? ~bits : bits | (uint64_t(1) << 63);
+                key.push_back(DOUBLE_KEY);
+                appendBigEndian(key, bits, 8);
+            } else if constexpr (std::is_same_v<T, bool>) {
+                key.push_back(BOOL_KEY);
+                key.push_back(value ? 1 : 0);
+            } else if constexpr (std::is_same_v<T, std::string>) {
+                key.push_back(STRING_KEY);
+                appendBytes(key, value.data(), value.size());
+            } else {
+                key.push_back(BYTES_KEY);
+                appendBytes(key, value.data(), value.size());
+            }
+        },
+        value);
+}
+
+void OrderedIndex::Iterator::skipEmpty() {
+    while (leaf_ != kNone && pos_ >= index_->leaves_[leaf_].keys.size()) {
+        leaf_ = index_->leaves_[leaf_].next;
+        pos_ = 0;
+    }
+    if (leaf_ == kNone) {
+        pos_ = 0;
+    }
+}
+
+void OrderedIndex::insert(std::string key, size_t row) {
+    if (leaves_.empty()) {
+        leaves_.emplace_back();
+        root_ = 0;
+        height_ = 0;
+    }
+    // inner nodes passed on the way down and the child taken in each
+    std::vector<std::pair<uint32_t, size_t>> path;
+    uint32_t node = root_;
+    for (size_t level = height_; level > 0; --level) {
+        const Inner& inner = inners_[node];
+        size_t child = entryBound(inner.keys, inner.rows, key, row, true);
+        path.emplace_back(node, child);
+        node = inner.children[child];
+    }
+
+    Leaf& leaf = leaves_[node];
+    size_t pos = entryBound(leaf.keys, leaf.rows, key, row, true);
+    leaf.keys.insert(leaf.keys.begin() + pos, std::move(key));
+    leaf.rows.insert(leaf.rows.begin() + pos, row);
+    ++size_;
+    if (leaf.keys.size() <= kNodeSize) {
+        return;
+    }
+
+    // the upper half of a full node moves to a new right sibling, whose
+    // first entry becomes a separator in the parent
+    auto right = static_cast<uint32_t>(leaves_.size());
+    leaves_.emplace_back();
+    Leaf& left = leaves_[node];
+    Leaf& split = leaves_[right];
+    size_t half = left.keys.size() / 2;
+    split.keys.assign(std::make_move_iterator(left.keys.begin() + half),
+                      std::make_move_iterator(left.keys.end()));
+    split.rows.assign(left.rows.begin() + half, left.rows.end());
+    left.keys.resize(half);
+    left.rows.resize(half);
+    split.next = left.next;
+    left.next = right;
+
+    std::string separator = split.keys.front();
+    size_t separatorRow = split.rows.front();
+    uint32_t child = right;
+    while (!path.empty()) {
+        auto [parent, pos] = path.back();
+        path.pop_back();
+        Inner& inner = inners_[parent];
+        inner.keys.insert(inner.keys.begin() + pos, std::move(separator));
+        inner.rows.insert(inner.rows.begin() + pos, separatorRow);
+        inner.children.insert(inner.children.begin() + pos + 1, child);
+        if (inner.keys.size() <= kNodeSize) {
+            return;
+        }
+
+        auto sibling = static_cast<uint32_t>(inners_.size());
+        inners_.emplace_back();
+        Inner& full = inners_[parent];
+        Inner& next = inners_[sibling];
+        size_t middle = full.keys.size() / 2;
+        separator = std::move(full.keys[middle]);
+        separatorRow = full.rows[middle];
+        auto moved = full.keys.begin() + middle + 1;
+        next.keys.assign(std::make_move_iterator(moved),
+                         std::make_move_iterator(full.keys.end()));
+        next.rows.assign(full.rows.begin() + middle + 1, full.rows.end());
+        next.children.assign(full.children.begin() + middle + 1,
+                             full.children.end());
+        full.keys.resize(middle);
+        full.rows.resize(middle);
+        full.children.resize(middle + 1);
+        child = sibling;
+    }
+
+    Inner root;
+    root.keys.push_back(std::move(separator));
+    root.rows.push_back(separatorRow);
+    root.children = {root_, child};
+    root_ = static_cast<uint32_t>(inners_.size());
+    inners_.push_back(std::move(root));
+    ++height_;
+}
+
+bool OrderedIndex::erase(const std::string& key, size_t row) {
+    if (leaves_.empty()) {
+        return false;
+    }
+    uint32_t node = root_;
+    for (size_t level = height_; level > 0; --level) {
+        const Inner& inner = inners_[node];
+        node = inner.children[entryBound(inner.keys, inner.rows, key, row,
+                                         true)];
+    }
+    Leaf& leaf = leaves_[node];
+    size_t pos = entryBound(leaf.keys, leaf.rows, key, row, false);
+    if (pos == leaf.keys.size() || leaf.keys[pos] != key ||
+        leaf.rows[pos] != row) {
+        return false;
+    }
+    leaf.keys.erase(leaf.keys.begin() + pos);
+    leaf.rows.erase(leaf.rows.begin() + pos);
+    --size_;
+    return true;
+}
+
+void OrderedIndex::clear() {
+    leaves_ = std::vector<Leaf>();
+    inners_ = std::vector<Inner>();
+    root_ = 0;
+    height_ = 0;
+    size_ = 0;
+}
+
+void OrderedIndex::assign(
+    std::vector<std::pair<std::string, size_t>> entries) {
+    clear();
+    if (entries.empty()) {
+        return;
+    }
+    size_ = entries.size();
+
+    // first entry of every node of the level being built
+    std::vector<uint32_t> nodes;
+    std::vector<size_t> firsts;
+    leaves_.reserve((entries.size() + kNodeSize - 1) / kNodeSize);
+    for (size_t begin = 0; begin < entries.size(); begin += kNodeSize) {
+        size_t end = std::min(begin + kNodeSize, entries.size());
+        Leaf& leaf = leaves_.emplace_back();
+        leaf.keys.reserve(end - begin);
+        leaf.rows.reserve(end - begin);
+        for (size_t i = begin; i < end; ++i) {
+            leaf.keys.push_back(entries[i].first);
+            leaf.rows.push_back(entries[i].second);
+        }
+        if (end < entries.size()) {
+            leaf.next = static_cast<uint32_t>(leaves_.size());
+        }
+        nodes.push_back(static_cast<uint32_t>(leaves_.size() - 1));
+        firsts.push_back(begin);
+    }
+
+    while (nodes.size() > 1) {
+        std::vector<uint32_t> parents;
+        std::vector<size_t> parentFirsts;
+        for (size_t begin = 0; begin < nodes.size(); begin += kNodeSize + 1) {
+            size_t end = std::min(begin + kNodeSize + 1, nodes.size());
+            Inner& inner = inners_.emplace_back();
+            inner.children.assign(nodes.begin() + begin, nodes.begin() + end);
+            for (size_t i = begin + 1; i < end; ++i) {
+                inner.keys.push_back(entries[firsts[i]].first);
+                inner.rows.push_back(entries[firsts[i]].second);
+            }
+            parents.push_back(static_cast<uint32_t>(inners_.size() - 1));
+            parentFirsts.push_back(firsts[begin]);
+        }
+        nodes = std::move(parents);
+        firsts = std::move(parentFirsts);
+        ++height_;
+    }
+    root_ = nodes.front();
+}
+
+uint32_t OrderedIndex::findLeaf(const std::string& key, bool upper) const {
+    uint32_t node = root_;
+    for (size_t level = height_; level > 0; --level) {
+        const Inner& inner = inners_[node];
+        node = inner.children[keyBound(inner.keys, key, upper)];
+    }
+    return node;
+}
+
+OrderedIndex::Iterator OrderedIndex::lowerBound(const std::string& key) const {
+    if (leaves_.empty()) {
+        return end();
+    }
+    uint32_t leaf = findLeaf(key, false);
+    return {this, leaf, keyBound(leaves_[leaf].keys, key, false)};
+}
+
+OrderedIndex::Iterator OrderedIndex::upperBound(const std::string& key) const {
+    if (leaves_.empty()) {
+        return end();
+    }
+    uint32_t leaf = findLeaf(key, true);
+    return {this, leaf, keyBound(leaves_[leaf].keys, key, true)};
+}
+
+size_t OrderedIndex::count(const std::string& key) const {
+    size_t result = 0;
+    for (auto it = lowerBound(key); it != end() && it.key() == key; ++it) {
+        ++result;
+    }
+    return result;
+}
+
+size_t OrderedIndex::memoryUsage() const {
+    size_t bytes = leaves_.capacity() * sizeof(Leaf) +
+                   inners_.capacity() * sizeof(Inner);
+    for (const auto& leaf : leaves_) {
+        bytes += keysMemoryUsage(leaf.keys) +
+                 leaf.rows.capacity() * sizeof(size_t);
+    }
+    for (const auto& inner : inners_) {
+        bytes += keysMemoryUsage(inner.keys) +
+                 inner.rows.capacity() * sizeof(size_t) +
+                 inner.children.capacity() * sizeof(uint32_t);
+    }
+    return bytes;
+}
+
+}  // namespace database
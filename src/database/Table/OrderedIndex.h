@@ -0,0 +1,123 @@
+#ifndef DATABASE_CONTROLLER_HSE_ORDEREDINDEX_H
+#define DATABASE_CONTROLLER_HSE_ORDEREDINDEX_H
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../../types.h"
+
+namespace database {
+
+// B+tree of (key, row) entries ordered by key and then by row, used by
+// ORDERED and KEY indexes. Keys are byte strings built by encode, which
+// compare with memcmp in the order of the values, so the tree never looks at
+// types. Nodes live in two vectors and refer to each other by position, and
+// the leaves are chained for sequential scans. Erased entries are removed
+// from their leaf without merging nodes; assign rebuilds a packed tree.
+class OrderedIndex {
+   public:
+    static constexpr size_t kNodeSize = 64;
+
+    // Appends the encoding of value to key. Values of the same type compare
+    // as the values do, and the encodings of a composite key are simply
+    // concatenated: no encoding is a prefix of another one.
+    static void appendKey(std::string& key, const DBType& value);
+    static std::string encode(const DBType& value) {
+        std::string key;
+        appendKey(key, value);
+        return key;
+    }
+    // A key greater than every key that starts with prefix, which is a
+    // whole number of encoded values.
+    static std::string prefixEnd(const std::string& prefix) {
+        return prefix + '\xff';
+    }
+
+    class Iterator {
+       public:
+        const std::string& key() const {
+            return index_->leaves_[leaf_].keys[pos_];
+        }
+        size_t row() const { return index_->leaves_[leaf_].rows[pos_]; }
+
+        Iterator& operator++() {
+            ++pos_;
+            skipEmpty();
+            return *this;
+        }
+        bool operator==(const Iterator& other) const {
+            return leaf_ == other.leaf_ && pos_ == other.pos_;
+        }
+        bool operator!=(const Iterator& other) const {
+            return !(*this == other);
+        }
+
+       private:
+        friend class OrderedIndex;
+
+        Iterator(const OrderedIndex* index, uint32_t leaf, size_t pos)
+            : index_(index), leaf_(leaf), pos_(pos) {
+            skipEmpty();
+        }
+        void skipEmpty();
+
+        const OrderedIndex* index_;
+        uint32_t leaf_;
+        size_t pos_;
+    };
+
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+
+    void insert(std::string key, size_t row);
+    // False if there is no such entry.
+    bool erase(const std::string& key, size_t row);
+    void clear();
+    // Replaces the entries with ones sorted by key and row, filling the
+    // leaves completely.
+    void assign(std::vector<std::pair<std::string, size_t>> entries);
+
+    Iterator begin() const { return {this, leaves_.empty() ? kNone : 0, 0}; }
+    Iterator end() const { return {this, kNone, 0}; }
+    // First entry whose key is not less than key.
+    Iterator lowerBound(const std::string& key) const;
+    // First entry whose key is greater than key.
+    Iterator upperBound(const std::string& key) const;
+    size_t count(const std::string& key) const;
+
+    // Approximate bytes taken by the nodes and the keys.
+    size_t memoryUsage() const;
+
+   private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct Leaf {
+        std::vector<std::string> keys;
+        std::vector<size_t> rows;
+        uint32_t next = kNone;
+    };
+    // children[i] holds the entries below separator i and from separator
+    // i - 1 on; a separator is the first entry of the child right of it.
+    struct Inner {
+        std::vector<std::string> keys;
+        std::vector<size_t> rows;
+        std::vector<uint32_t> children;
+    };
+
+    // Leaf where key would be inserted before (upper == false) or after
+    // (upper == true) the entries with an equal key.
+    uint32_t findLeaf(const std::string& key, bool upper) const;
+
+    std::vector<Leaf> leaves_;
+    std::vector<Inner> inners_;
+    // index into inners_, or into leaves_ while the tree is a single leaf
+    uint32_t root_ = 0;
+    size_t height_ = 0;
+    size_t size_ = 0;
+};
+
+}  // namespace database
+
+#endif  // DATABASE_CONTROLLER_HSE_ORDEREDINDEX_H
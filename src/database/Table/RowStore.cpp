@@ -0,0 +1,322 @@
+#include "RowStore.h"
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+
+namespace database {
+
+RowStore::RowStore(const SchemeType& scheme)
+    : Storage(scheme), fields_(scheme.size()), bits_(scheme.size()) {
+    size_t bools = 0;
+    for (size_t i = 0; i < scheme.size(); ++i) {
+        switch (scheme[i].type) {
+            case DataTypeName::INT:
+                fields_[i] = recordSize_;
+                recordSize_ += sizeof(int);
+                break;
+            case DataTypeName::DOUBLE:
+                fields_[i] = recordSize_;
+                recordSize_ += sizeof(double);
+                break;
+            case DataTypeName::STRING:
+            case DataTypeName::BYTEBUFFER:
+                fields_[i] = recordSize_;
+                recordSize_ += inHeap(i) ? sizeof(HeapRef) : sizeof(uint32_t);
+                break;
+            case DataTypeName::BOOL:
+                ++bools;
+                break;
+        }
+    }
+
+    size_t bit = 0;
+    for (size_t i = 0; i < scheme.size(); ++i) {
+        if (scheme[i].type == DataTypeName::BOOL) {
+            fields_[i] = recordSize_ + bit / 8;
+            bits_[i] = static_cast<uint8_t>(1 << (bit % 8));
+            ++bit;
+        }
+    }
+    recordSize_ += (bools + 7) / 8;
+}
+
+void RowStore::append(const RowType& row) {
+    validate(row);
+    checkHeap(heapBytes(row));
+    records_.resize(records_.size() + recordSize_);
+    ++size_;
+    for (size_t i = 0; i < scheme_.size(); ++i) {
+        set(size_ - 1, i, row[i]);
+    }
+    extendZoneMap(size_ - 1, row);
+}
+
+void RowStore::reserve(size_t size) { records_.reserve(size * recordSize_); }
+
+RowType RowStore::row(size_t index) const {
+    RowType row;
+    row.reserve(scheme_.size());
+    for (size_t i = 0; i < scheme_.size(); ++i) {
+        row.push_back(value(i, index));
+    }
+    return row;
+}
+
+void RowStore::setRow(size_t index, const RowType& row) {
+    validate(row);
+    checkHeap(heapBytes(row));
+    for (size_t i = 0; i < scheme_.size(); ++i) {
+        set(index, i, row[i]);
+    }
+    extendZoneMap(index, row);
+    compactHeap();
+}
+
+void RowStore::erase(const std::vector<size_t>& rows) {
+    if (rows.empty()) {
+        return;
+    }
+    size_t next = 0;
+    size_t kept = 0;
+    for (size_t row = 0; row < size_; ++row) {
+        if (next < rows.size() && rows[next] == row) {
+            for (size_t i = 0; i < scheme_.size(); ++i) {
+                if (inHeap(i)) {
+                    garbage_ += getRef(row, i).length;
+                }
+            }
+            ++next;
+            continue;
+        }
+        if (kept != row) {
+            std::memcpy(records_.data() + kept * recordSize_,
+                        records_.data() + row * recordSize_, recordSize_);
+        }
+        ++kept;
+    }
+    size_ = kept;
+    records_.resize(size_ * recordSize_);
+    compactHeap();
+    rebuildZoneMaps();
+}
+
+void RowStore::clear() {
+    records_ = std::vector<char>();
+    heap_ = std::vector<char>();
+    garbage_ = 0;
+    size_ = 0;
+    zoneMaps_.clear();
+    for (auto& dictionary : dictionaries_) {
+        dictionary = {};
+    }
+}
+
+size_t RowStore::memoryUsage() const {
+    return records_.capacity() + heap_.capacity() + sharedMemoryUsage();
+}
+
+const int* RowStore::ints(size_t offset, size_t begin, size_t count,
+                          int* buffer) const {
+    if (scheme_[offset].type != DataTypeName::INT) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(&buffer[i], field(begin + i, offset), sizeof(int));
+    }
+    return buffer;
+}
+
+const double* RowStore::doubles(size_t offset, size_t begin, size_t count,
+                                double* buffer) const {
+    if (scheme_[offset].type != DataTypeName::DOUBLE) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        std::memcpy(&buffer[i], field(begin + i, offset), sizeof(double));
+    }
+    return buffer;
+}
+
+const bool* RowStore::bools(size_t offset, size_t begin, size_t count,
+                            bool* buffer) const {
+    if (scheme_[offset].type != DataTypeName::BOOL) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        buffer[i] = getBool(begin + i, offset);
+    }
+    return buffer;
+}
+
+bool RowStore::strings(size_t offset, size_t begin, size_t count,
+                       std::string_view* views) const {
+    if (scheme_[offset].type != DataTypeName::STRING) {
+        return false;
+    }
+    if (const Dictionary* values = dictionary(offset)) {
+        for (size_t i = 0; i < count; ++i) {
+            views[i] = values->decode(getCode(begin + i, offset));
+        }
+        return true;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        views[i] = getBytes(begin + i, offset);
+    }
+    return true;
+}
+
+const uint32_t* RowStore::codes(size_t offset, size_t begin, size_t count,
+                                uint32_t* buffer) const {
+    if (dictionary(offset) == nullptr) {
+        return nullptr;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        buffer[i] = getCode(begin + i, offset);
+    }
+    return buffer;
+}
+
+DBType RowStore::value(size_t offset, size_t row) const {
+    switch (scheme_[offset].type) {
+        case DataTypeName::INT: {
+            int value;
+            std::memcpy(&value, field(row, offset), sizeof(int));
+            return value;
+        }
+        case DataTypeName::DOUBLE: {
+            double value;
+            std::memcpy(&value, field(row, offset), sizeof(double));
+            return value;
+        }
+        case DataTypeName::BOOL:
+            return getBool(row, offset);
+        case DataTypeName::STRING:
+            if (const Dictionary* values = dictionary(offset)) {
+                return values->decode(getCode(row, offset));
+            }
+            return std::string(getBytes(row, offset));
+        case DataTypeName::BYTEBUFFER: {
+            std::string_view bytes = getBytes(row, offset);
+            return bytebuffer(bytes.begin(), bytes.end());
+        }
+    }
+    return {};
+}
+
+bool RowStore::getBool(size_t row, size_t offset) const {
+    return (static_cast<uint8_t>(*field(row, offset)) & bits_[offset]) != 0;
+}
+
+uint32_t RowStore::getCode(size_t row, size_t offset) const {
+    uint32_t code;
+    std::memcpy(&code, field(row, offset), sizeof(uint32_t));
+    return code;
+}
+
+RowStore::HeapRef RowStore::getRef(size_t row, size_t offset) const {
+    HeapRef ref;
+    std::memcpy(&ref, field(row, offset), sizeof(HeapRef));
+    return ref;
+}
+
+std::string_view RowStore::getBytes(size_t row, size_t offset) const {
+    HeapRef ref = getRef(row, offset);
+    return std::string_view(heap_.data() + ref.offset, ref.length);
+}
+
+void RowStore::set(size_t row, size_t offset, const DBType& value) {
+    switch (scheme_[offset].type) {
+        case DataTypeName::INT:
+            std::memcpy(field(row, offset), &std::get<int>(value),
+                        sizeof(int));
+            break;
+        case DataTypeName::DOUBLE: {
+            double number = std::holds_alternative<int>(value)
+                                ? std::get<int>(value)
+                                : std::get<double>(value);
+            std::memcpy(field(row, offset), &number, sizeof(double));
+            break;
+        }
+        case DataTypeName::BOOL: {
+            char& byte = *field(row, offset);
+            byte = static_cast<char>(std::get<bool>(value)
+                                         ? byte | bits_[offset]
+                                         : byte & ~bits_[offset]);
+            break;
+        }
+        case DataTypeName::STRING:
+            if (scheme_[offset].isDictionary) {
+                uint32_t code =
+                    dictionaries_[offset].encode(std::get<std::string>(value));
+                std::memcpy(field(row, offset), &code, sizeof(uint32_t));
+            } else {
+                setBytes(row, offset, std::get<std::string>(value));
+            }
+            break;
+        case DataTypeName::BYTEBUFFER: {
+            const auto& buffer = std::get<bytebuffer>(value);
+            setBytes(row, offset,
+                     std::string_view(buffer.data(), buffer.size()));
+            break;
+        }
+    }
+}
+
+void RowStore::setBytes(size_t row, size_t offset, std::string_view bytes) {
+    if (getBytes(row, offset) == bytes) {
+        return;
+    }
+    HeapRef ref;
+    ref.offset = static_cast<uint32_t>(heap_.size());
+    ref.length = static_cast<uint32_t>(bytes.size());
+    garbage_ += getRef(row, offset).length;
+    heap_.insert(heap_.end(), bytes.begin(), bytes.end());
+    std::memcpy(field(row, offset), &ref, sizeof(HeapRef));
+}
+
+size_t RowStore::heapBytes(const RowType& row) const {
+    size_t bytes = 0;
+    for (size_t i = 0; i < scheme_.size(); ++i) {
+        if (!inHeap(i)) {
+            continue;
+        }
+        if (const auto* text = std::get_if<std::string>(&row[i])) {
+            bytes += text->size();
+        } else {
+            bytes += std::get<bytebuffer>(row[i]).size();
+        }
+    }
+    return bytes;
+}
+
+void RowStore::checkHeap(size_t bytes) const {
+    if (bytes > std::numeric_limits<uint32_t>::max() - heap_.size()) {
+        throw std::runtime_error("String heap size limit exceeded.");
+    }
+}
+
+void RowStore::compactHeap() {
+    if (garbage_ <= heap_.size() / 2) {
+        return;
+    }
+    std::vector<char> heap;
+    heap.reserve(heap_.size() - garbage_);
+    for (size_t row = 0; row < size_; ++row) {
+        for (size_t i = 0; i < scheme_.size(); ++i) {
+            if (!inHeap(i)) {
+                continue;
+            }
+            HeapRef ref = getRef(row, i);
+            const char* bytes = heap_.data() + ref.offset;
+            ref.offset = static_cast<uint32_t>(heap.size());
+            heap.insert(heap.end(), bytes, bytes + ref.length);
+            std::memcpy(field(row, i), &ref, sizeof(HeapRef));
+        }
+    }
+    heap_ = std::move(heap);
+    garbage_ = 0;
+}
+
+}  // namespace database
@@ -0,0 +1,89 @@
+#ifndef DATABASE_CONTROLLER_HSE_ROWSTORE_H
+#define DATABASE_CONTROLLER_HSE_ROWSTORE_H
+
+#include <cstdint>
+#include <vector>
+
+#include "../../types.h"
+#include "Storage.h"
+
+namespace database {
+
+// Storage of a ROW table: fixed-width records laid out from the scheme (INT
+// takes 4 bytes, DOUBLE 8, BOOL one bit) in a single buffer. VARCHAR and
+// BYTEBUFFER values live in a per-table heap and the record keeps their
+// offset and length. Dictionary-encoded VARCHAR columns store a 4-byte code.
+class RowStore : public Storage {
+   public:
+    RowStore() = default;
+    explicit RowStore(const SchemeType& scheme);
+
+    void append(const RowType& row) override;
+    void reserve(size_t size) override;
+
+    RowType row(size_t index) const override;
+    void setRow(size_t index, const RowType& row) override;
+
+    size_t heapBytes(const RowType& row) const override;
+    void checkHeap(size_t bytes) const override;
+
+    void erase(const std::vector<size_t>& rows) override;
+    void clear() override;
+    size_t memoryUsage() const override;
+
+    size_t recordSize() const { return recordSize_; }
+    size_t heapSize() const { return heap_.size(); }
+
+    const int* ints(size_t offset, size_t begin, size_t count,
+                    int* buffer) const override;
+    const double* doubles(size_t offset, size_t begin, size_t count,
+                          double* buffer) const override;
+    const bool* bools(size_t offset, size_t begin, size_t count,
+                      bool* buffer) const override;
+    bool strings(size_t offset, size_t begin, size_t count,
+                 std::string_view* views) const override;
+    const uint32_t* codes(size_t offset, size_t begin, size_t count,
+                          uint32_t* buffer) const override;
+    DBType value(size_t offset, size_t row) const override;
+
+   private:
+    struct HeapRef {
+        uint32_t offset = 0;
+        uint32_t length = 0;
+    };
+
+    const char* field(size_t row, size_t offset) const {
+        return records_.data() + row * recordSize_ + fields_[offset];
+    }
+    char* field(size_t row, size_t offset) {
+        return records_.data() + row * recordSize_ + fields_[offset];
+    }
+    bool inHeap(size_t offset) const {
+        return scheme_[offset].type == DataTypeName::BYTEBUFFER ||
+               (scheme_[offset].type == DataTypeName::STRING &&
+                !scheme_[offset].isDictionary);
+    }
+    bool getBool(size_t row, size_t offset) const;
+    uint32_t getCode(size_t row, size_t offset) const;
+    HeapRef getRef(size_t row, size_t offset) const;
+    std::string_view getBytes(size_t row, size_t offset) const;
+
+    void set(size_t row, size_t offset, const DBType& value);
+    void setBytes(size_t row, size_t offset, std::string_view bytes);
+    // Rewrites the heap without the bytes of replaced and erased values once
+    // they take more than half of it.
+    void compactHeap();
+
+    // byte offset of each column in a record; for BOOL columns the offset of
+    // the byte holding its bit
+    std::vector<size_t> fields_;
+    std::vector<uint8_t> bits_;
+    size_t recordSize_ = 0;
+    std::vector<char> records_;
+    std::vector<char> heap_;
+    size_t garbage_ = 0;
+};
+
+}  // namespace database
+
+#endif  // DATABASE_CONTROLLER_HSE_ROWSTORE_H
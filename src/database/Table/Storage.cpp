@@ -0,0 +1,99 @@
+#include "Storage.h"
+
+#include <stdexcept>
+
+namespace database {
+
+namespace {
+
+bool hasColumnType(DataTypeName type, const DBType& value) {
+    switch (type) {
+        case DataTypeName::INT:
+            return std::holds_alternative<int>(value);
+        case DataTypeName::DOUBLE:
+            return std::holds_alternative<double>(value) ||
+                   std::holds_alternative<int>(value);
+        case DataTypeName::BOOL:
+            return std::holds_alternative<bool>(value);
+        case DataTypeName::STRING:
+            return std::holds_alternative<std::string>(value);
+        case DataTypeName::BYTEBUFFER:
+            return std::holds_alternative<bytebuffer>(value);
+    }
+    return false;
+}
+
+}  // namespace
+
+void Storage::validate(const RowType& row) const {
+    if (row.size() != scheme_.size()) {
+        throw std::runtime_error(
+            "Number of values does not match number of columns.");
+    }
+    for (size_t i = 0; i < scheme_.size(); ++i) {
+        if (!hasColumnType(scheme_[i].type, row[i])) {
+            throw std::runtime_error("Type mismatch for column " +
+                                     scheme_[i].name);
+        }
+    }
+}
+
+void Storage::extendZoneMap(size_t index, const RowType& row) {
+    size_t group = index / kRowGroupSize;
+    if (group >= zoneMaps_.size()) {
+        zoneMaps_.resize(group + 1,
+                         std::vector<calculator::ColumnRange>(scheme_.size()));
+    }
+    auto& ranges = zoneMaps_[group];
+    for (size_t i = 0; i < scheme_.size(); ++i) {
+        if (scheme_[i].type == DataTypeName::BYTEBUFFER) {
+            continue;
+        }
+        const DBType* value = &row[i];
+        DBType converted;
+        if (scheme_[i].type == DataTypeName::DOUBLE &&
+            std::holds_alternative<int>(*value)) {
+            converted = static_cast<double>(std::get<int>(*value));
+            value = &converted;
+        }
+        auto& range = ranges[i];
+        if (!range.known) {
+            range.known = true;
+            range.min = *value;
+            range.max = *value;
+        } else if (*value < range.min) {
+            range.min = *value;
+        } else if (range.max < *value) {
+            range.max = *value;
+        }
+    }
+}
+
+void Storage::rebuildZoneMaps() {
+    zoneMaps_.clear();
+    for (size_t index = 0; index < size_; ++index) {
+        extendZoneMap(index, row(index));
+    }
+}
+
+size_t Storage::sharedMemoryUsage() const {
+    size_t bytes = 0;
+    for (const auto& dictionary : dictionaries_) {
+        bytes += dictionary.memoryUsage();
+    }
+    for (const auto& ranges : zoneMaps_) {
+        for (const auto& range : ranges) {
+            bytes += database::memoryUsage(range.min) +
+                     database::memoryUsage(range.max);
+        }
+    }
+    return bytes;
+}
+
+bool Storage::findCode(size_t offset, std::string_view value,
+                       uint32_t& code) const {
+    const Dictionary* values = dictionary(offset);
+    return values != nullptr && values->find(value, code);
+}
+
+}  // namespace database
@@ -0,0 +1,87 @@
+#ifndef DATABASE_CONTROLLER_HSE_STORAGE_H
+#define DATABASE_CONTROLLER_HSE_STORAGE_H
+
+#include <vector>
+
+#include "../../Calculator/CompiledExpression.h"
+#include "../../types.h"
+#include "Dictionary.h"
+
+namespace database {
+
+// Rows of a Table: RowStore for ROW tables, ColumnStore for COLUMNAR ones.
+// Both are filtered by compiled predicates through the ColumnSource
+// accessors and convert to RowType only when rows are read or written whole.
+class Storage : public calculator::ColumnSource {
+   public:
+    // Rows are split into groups of this size, each with the range of every
+    // column, so that scans can skip the groups a predicate cannot match.
+    static constexpr size_t kRowGroupSize = 64 * 1024;
+
+    Storage() = default;
+    explicit Storage(const SchemeType& scheme)
+        : scheme_(scheme), dictionaries_(scheme.size()) {}
+
+    size_t size() const { return size_; }
+
+    // Throws if the row has the wrong number of values or a value does not
+    // have the type of its column. INT values are accepted for DOUBLE
+    // columns and converted when stored.
+    void validate(const RowType& row) const;
+    // Bytes the values of row take outside of its record, e.g. in a string
+    // heap; 0 for storages that keep every value in place.
+    virtual size_t heapBytes(const RowType&) const { return 0; }
+    // Throws if that many more heap bytes could not be stored. Table calls
+    // it for a whole batch before changing anything, so that rows that do
+    // not fit leave the table as it was.
+    virtual void checkHeap(size_t) const {}
+
+    virtual void append(const RowType& row) = 0;
+    virtual void reserve(size_t size) = 0;
+
+    virtual RowType row(size_t index) const = 0;
+    virtual void setRow(size_t index, const RowType& row) = 0;
+    // Called after a batch of setRow calls to redo work the storage put off
+    // while the rows were changed one by one.
+    virtual void flush() {}
+
+    // Removes the rows listed in ascending order in rows.
+    virtual void erase(const std::vector<size_t>& rows) = 0;
+    virtual void clear() = 0;
+
+    // Approximate bytes taken by the rows, dictionaries and zone maps.
+    virtual size_t memoryUsage() const = 0;
+
+    // nullptr unless the column is dictionary-encoded
+    const Dictionary* dictionary(size_t offset) const {
+        return scheme_[offset].isDictionary ? &dictionaries_[offset] : nullptr;
+    }
+    bool findCode(size_t offset, std::string_view value,
+                  uint32_t& code) const override;
+
+    size_t groupCount() const { return zoneMaps_.size(); }
+    // Ranges of the columns (indexed by offset) over the rows of group. They
+    // only grow when rows are changed and are recomputed when rows are
+    // erased. BYTEBUFFER columns are not tracked.
+    const std::vector<calculator::ColumnRange>& zoneMap(size_t group) const {
+        return zoneMaps_[group];
+    }
+
+   protected:
+    // Widens the zone map of the group of index by the values of row; called
+    // by append and setRow.
+    void extendZoneMap(size_t index, const RowType& row);
+    // Recomputes every zone map from the stored rows; called after erase.
+    void rebuildZoneMaps();
+    // Bytes of the dictionaries and zone maps, for memoryUsage.
+    size_t sharedMemoryUsage() const;
+
+    SchemeType scheme_;
+    std::vector<Dictionary> dictionaries_;
+    size_t size_ = 0;
+    std::vector<std::vector<calculator::ColumnRange>> zoneMaps_;
+};
+
+}  // namespace database
+
+#endif  // DATABASE_CONTROLLER_HSE_STORAGE_H
@@ -12,6 +12,8 @@
 #include <vector>
 #include <sstream>
 #include <memory>
+#include <numeric>
+#include <optional>
 #include <iostream>
 
 #include "../../Calculator/Calculator.h"
@@ -40,11 +42,28 @@ std::string dBTypeToString(DBType value) {
     return str_value;
 }
 
+namespace {
+
+DBType storedValue(const ColumnDefinition& column, const DBType& value) {
+    if (column.type == DataTypeName::DOUBLE &&
+        std::holds_alternative<int>(value)) {
+        return static_cast<double>(std::get<int>(value));
+    }
+    return value;
+}
+
+// Key of a value in the index of a KEY column.
+std::string encodedValue(const ColumnDefinition& column, const DBType& value) {
+    return OrderedIndex::encode(storedValue(column, value));
+}
+
+}  // namespace
+
 std::string Table::convert_to_byte_buffer() {
     std::string buffer;
-    for (auto& row : rows_) {
+    for (const auto& row : get_rows()) {
         int current_column_index = 0;
-        for (auto& cell : row) {
+        for (const auto& cell : row) {
             union {
                 int intValue;
                 double doubleValue;
@@ -108,15 +127,172 @@ void Table::load_from_byte_buffer(const std::string& buffer) {
         }
         rows.push_back(row);
     }
-    rows_ = rows;
+    drop_rows();
+    storage().reserve(rows.size());
+    for (const auto& row : rows) {
+        storage().append(row);
+    }
+    for (size_t i = 0; i < scheme_.size(); ++i) {
+        if (scheme_[i].isUnique) {
+            unique_values_[i].reserve(rows.size());
+            for (const auto& row : rows) {
+                unique_values_[i].insert(storedValue(scheme_[i], row[i]));
+            }
+        }
+    }
+    for (auto& [name, index] : indexes_) {
+        build_index(index);
+    }
+}
+
+TableView Table::get_rows() const { return TableView(*this, get_row_ids()); }
+
+void Table::read_rows(std::pmr::vector<DBType>& cells) const {
+    const Storage& rows = storage();
+    cells.reserve(cells.size() + size() * scheme_.size());
+    for (size_t row = 0; row < rows.size(); ++row) {
+        if (is_deleted(row)) {
+            continue;
+        }
+        for (size_t offset = 0; offset < scheme_.size(); ++offset) {
+            cells.push_back(rows.value(offset, row));
+        }
+    }
+}
+
+std::vector<size_t> Table::get_row_ids() const {
+    std::vector<size_t> ids;
+    ids.reserve(size());
+    for (size_t row = 0; row < storage().size(); ++row) {
+        if (!is_deleted(row)) {
+            ids.push_back(row);
+        }
+    }
+    return ids;
+}
+
+RowType Table::get_row(size_t index) const { return storage().row(index); }
+
+void Table::set_row(size_t index, const RowType& row) {
+    apply_updates({{index, row}});
+}
+
+void Table::set_rows(const std::vector<std::pair<size_t, RowType>>& rows) {
+    apply_updates(rows);
+}
+
+void Table::check_rows(
+    const std::vector<std::pair<size_t, RowType>>& rows) const {
+    std::vector<std::vector<DBType>> removed(scheme_.size());
+    std::vector<std::vector<DBType>> added(scheme_.size());
+    check_updates(rows, removed, added);
+}
+
+DBType Table::get_value(size_t row, size_t offset) const {
+    return storage().value(offset, row);
+}
+
+void Table::apply_updates(
+    const std::vector<std::pair<size_t, RowType>>& updates) {
+    if (updates.empty()) {
+        return;
+    }
+    std::vector<std::vector<DBType>> removed(scheme_.size());
+    std::vector<std::vector<DBType>> added(scheme_.size());
+    check_updates(updates, removed, added);
+
+    for (const auto& [id, row] : updates) {
+        if (!indexes_.empty()) {
+            unindex_row(id, get_row(id));
+            index_row(id, row);
+        }
+        storage().setRow(id, row);
+    }
+    storage().flush();
+    for (size_t i = 0; i < scheme_.size(); ++i) {
+        for (const auto& value : removed[i]) {
+            unique_values_[i].erase(value);
+        }
+        for (auto& value : added[i]) {
+            unique_values_[i].insert(std::move(value));
+        }
+    }
+}
+
+void Table::check_updates(
+    const std::vector<std::pair<size_t, RowType>>& updates,
+    std::vector<std::vector<DBType>>& removed,
+    std::vector<std::vector<DBType>>& added) const {
+    // replaced values stay in the heap until it is compacted, so the new
+    // ones must fit next to them
+    size_t heapBytes = 0;
+    for (const auto& [index, row] : updates) {
+        storage().validate(row);
+        heapBytes += storage().heapBytes(row);
+    }
+    storage().checkHeap(heapBytes);
+
+    // a value may move from one updated row to another, so the old values
+    // of the batch are set aside before the new ones are checked
+    for (size_t i = 0; i < scheme_.size(); ++i) {
+        if (!scheme_[i].isUnique) {
+            continue;
+        }
+        std::unordered_set<DBType, DBTypeHash> leaving;
+        for (const auto& [index, row] : updates) {
+            DBType value = storedValue(scheme_[i], row[i]);
+            DBType old = get_value(index, i);
+            if (value != old) {
+                leaving.insert(old);
+                removed[i].push_back(std::move(old));
+                added[i].push_back(std::move(value));
+            }
+        }
+        std::unordered_set<DBType, DBTypeHash> entering;
+        for (const auto& value : added[i]) {
+            if (!entering.insert(value).second ||
+                (unique_values_[i].count(value) && !leaving.count(value))) {
+                throw std::runtime_error(
+                    "Unique constraint violated for column: " +
+                    scheme_[i].name);
+            }
+        }
+    }
+
+    for (size_t i : key_columns_) {
+        const auto& index = indexes_.at(scheme_[i].name).orderedIndex;
+        std::unordered_set<std::string> leaving;
+        std::vector<std::string> entering;
+        for (const auto& [id, row] : updates) {
+            std::string key = encodedValue(scheme_[i], row[i]);
+            std::string old = OrderedIndex::encode(get_value(id, i));
+            if (key != old) {
+                leaving.insert(std::move(old));
+                entering.push_back(std::move(key));
+            }
+        }
+        std::unordered_set<std::string> batch;
+        for (auto& key : entering) {
+            if ((index.count(key) && !leaving.count(key)) ||
+                !batch.insert(std::move(key)).second) {
+                throw std::runtime_error(
+                    "Key constraint violated for column: " + scheme_[i].name);
+            }
+        }
+    }
 }
 
 std::vector<RowType> Table::filter(
-    const std::function<bool(const RowType&)>& predicate) {
+    const std::function<bool(const RowType&)>& predicate) const {
+    const Storage& rows = storage();
     std::vector<RowType> result;
-    for (const auto& row : rows_) {
+    for (size_t index = 0; index < rows.size(); ++index) {
+        if (is_deleted(index)) {
+            continue;
+        }
+        RowType row = rows.row(index);
         if (predicate(row)) {
-            result.push_back(row);
+            result.push_back(std::move(row));
         }
     }
     return result;
@@ -125,23 +301,235 @@ std::vector<RowType> Table::filter(
 void Table::update_many(
     const std::function<void(std::vector<DBType>&)>& updater,
     const std::function<bool(const std::vector<DBType>&)>& predicate) {
-    for (auto& row : rows_) {
+    const Storage& rows = storage();
+    std::vector<std::pair<size_t, RowType>> updates;
+    for (size_t index = 0; index < rows.size(); ++index) {
+        if (is_deleted(index)) {
+            continue;
+        }
+        RowType row = rows.row(index);
         if (predicate(row)) {
             updater(row);
+            updates.emplace_back(index, std::move(row));
         }
     }
+    apply_updates(updates);
 }
 
 void Table::remove_many(
     const std::function<bool(const std::vector<DBType>&)>& predicate) {
-    std::vector<RowType> rows_to_remove;
-    for (auto& row : rows_) {
-        if (predicate(row)) {
-            rows_to_remove.push_back(row);
+    const Storage& rows = storage();
+    std::vector<size_t> rows_to_remove;
+    for (size_t index = 0; index < rows.size(); ++index) {
+        if (!is_deleted(index) && predicate(rows.row(index))) {
+            rows_to_remove.push_back(index);
+        }
+    }
+    delete_rows(rows_to_remove);
+}
+
+std::vector<RowType> Table::filter(
+    const calculator::CompiledExpression& predicate) const {
+    calculator::SelectionVector selection = select_rows(predicate);
+    std::vector<RowType> result;
+    result.reserve(selection.size());
+    for (size_t index : selection) {
+        result.push_back(storage().row(index));
+    }
+    return result;
+}
+
+void Table::update_many(
+    const std::function<void(std::vector<DBType>&)>& updater,
+    const calculator::CompiledExpression& predicate) {
+    update_rows(select_rows(predicate), updater);
+}
+
+void Table::remove_many(const calculator::CompiledExpression& predicate) {
+    remove_rows(select_rows(predicate));
+}
+
+calculator::SelectionVector Table::select_rows(
+    const calculator::CompiledExpression& predicate) const {
+    if (predicate.empty()) {
+        return get_row_ids();
+    }
+    calculator::SelectionVector selection;
+    if (predicate.alwaysFalse()) {
+        return selection;
+    }
+    if (lookup_index(predicate, selection)) {
+        // the index only narrows the rows down; the rest of the predicate
+        // is checked on each of them
+        size_t kept = 0;
+        for (size_t row : selection) {
+            if (calculator::safeGet<bool>(predicate.evaluate(get_row(row)))) {
+                selection[kept++] = row;
+            }
         }
+        selection.resize(kept);
+        return selection;
     }
-    for (auto& row : rows_to_remove) {
-        rows_.erase(std::find(rows_.begin(), rows_.end(), row));
+    const Storage& rows = storage();
+    for (size_t group = 0; group < rows.groupCount(); ++group) {
+        if (!predicate.mayMatch(rows.zoneMap(group))) {
+            continue;
+        }
+        size_t begin = group * Storage::kRowGroupSize;
+        predicate.select(
+            rows, begin, std::min(Storage::kRowGroupSize, rows.size() - begin),
+            selection);
+    }
+    skip_deleted(selection);
+    return selection;
+}
+
+TableView Table::view(const calculator::CompiledExpression& predicate) const {
+    return TableView(*this, select_rows(predicate));
+}
+
+void Table::update_rows(
+    const calculator::SelectionVector& rows,
+    const std::function<void(std::vector<DBType>&)>& updater) {
+    std::vector<std::pair<size_t, RowType>> updates;
+    updates.reserve(rows.size());
+    for (size_t index : rows) {
+        RowType row = storage().row(index);
+        updater(row);
+        updates.emplace_back(index, std::move(row));
+    }
+    apply_updates(updates);
+}
+
+void Table::remove_rows(const calculator::SelectionVector& rows) {
+    delete_rows(rows);
+}
+
+void Table::drop_rows() {
+    storage().clear();
+    deleted_.clear();
+    deleted_count_ = 0;
+    for (auto& [name, index] : indexes_) {
+        index.orderedIndex.clear();
+        index.unorderedIndex.clear();
+    }
+    for (auto& values : unique_values_) {
+        values.clear();
+    }
+}
+
+size_t Table::memory_usage() const {
+    // Hash nodes have a link and the cached hash; buckets are a pointer
+    // each.
+    constexpr size_t kHashNode = 2 * sizeof(void*);
+
+    size_t bytes = storage().memoryUsage() + deleted_.capacity() / 8;
+    for (const auto& [name, index] : indexes_) {
+        bytes += index.orderedIndex.memoryUsage();
+        bytes += index.unorderedIndex.bucket_count() * sizeof(void*);
+        for (const auto& [key, rows] : index.unorderedIndex) {
+            bytes += kHashNode + memoryUsage(key) + sizeof(rows) +
+                     rows.bucket_count() * sizeof(void*) +
+                     rows.size() * (kHashNode + sizeof(size_t));
+        }
+    }
+    for (const auto& values : unique_values_) {
+        bytes += values.bucket_count() * sizeof(void*);
+        for (const auto& value : values) {
+            bytes += kHashNode + memoryUsage(value);
+        }
+    }
+    return bytes;
+}
+
+void Table::delete_rows(const std::vector<size_t>& rows) {
+    if (rows.empty()) {
+        return;
+    }
+    deleted_.resize(storage().size());
+    size_t removed = 0;
+    for (size_t row : rows) {
+        // stale and repeated ids must not be counted or unindexed twice
+        if (row >= deleted_.size() || deleted_[row]) {
+            continue;
+        }
+        if (!indexes_.empty()) {
+            unindex_row(row, get_row(row));
+        }
+        deleted_[row] = true;
+        for (size_t i = 0; i < scheme_.size(); ++i) {
+            if (scheme_[i].isUnique) {
+                unique_values_[i].erase(get_value(row, i));
+            }
+        }
+        ++removed;
+    }
+    deleted_count_ += removed;
+    if (storage().size() >= kCompactMinRows &&
+        deleted_count_ * 2 >= storage().size()) {
+        compact();
+    }
+}
+
+void Table::skip_deleted(calculator::SelectionVector& selection) const {
+    if (deleted_count_ == 0) {
+        return;
+    }
+    selection.erase(std::remove_if(selection.begin(), selection.end(),
+                                   [this](size_t row) {
+                                       return is_deleted(row);
+                                   }),
+                    selection.end());
+}
+
+void Table::compact() {
+    if (deleted_count_ == 0) {
+        return;
+    }
+    constexpr size_t kRemoved = static_cast<size_t>(-1);
+    std::vector<size_t> removed;
+    removed.reserve(deleted_count_);
+    std::vector<size_t> ids(storage().size());
+    size_t next = 0;
+    for (size_t row = 0; row < ids.size(); ++row) {
+        if (is_deleted(row)) {
+            removed.push_back(row);
+            ids[row] = kRemoved;
+        } else {
+            ids[row] = next++;
+        }
+    }
+    storage().erase(removed);
+    deleted_.clear();
+    deleted_count_ = 0;
+
+    for (auto& [name, index] : indexes_) {
+        // renumbering keeps the order of the entries, so the tree is
+        // rebuilt from them packed
+        std::vector<std::pair<std::string, size_t>> entries;
+        entries.reserve(index.orderedIndex.size());
+        for (auto it = index.orderedIndex.begin();
+             it != index.orderedIndex.end(); ++it) {
+            if (ids[it.row()] != kRemoved) {
+                entries.emplace_back(it.key(), ids[it.row()]);
+            }
+        }
+        index.orderedIndex.assign(std::move(entries));
+        for (auto it = index.unorderedIndex.begin();
+             it != index.unorderedIndex.end();) {
+            std::unordered_set<size_t> rows;
+            for (size_t row : it->second) {
+                if (ids[row] != kRemoved) {
+                    rows.insert(ids[row]);
+                }
+            }
+            if (rows.empty()) {
+                it = index.unorderedIndex.erase(it);
+            } else {
+                it->second = std::move(rows);
+                ++it;
+            }
+        }
     }
 }
 
@@ -152,59 +540,165 @@ void Table::addUniqueConstraint(const std::string& columnName) {
     if (it == scheme_.end()) {
         throw std::runtime_error("Column not found: " + columnName);
     }
+    size_t offset = it - scheme_.begin();
+    std::unordered_set<DBType, DBTypeHash> values;
+    values.reserve(size());
+    for (size_t row = 0; row < storage().size(); ++row) {
+        if (!is_deleted(row) && !values.insert(get_value(row, offset)).second) {
+            throw std::runtime_error("Unique constraint violated for column: " +
+                                     columnName);
+        }
+    }
     it->isUnique = true;
+    unique_values_[offset] = std::move(values);
+    plan_inserts();
+}
+
+void Table::plan_inserts() {
+    ++scheme_version_;
+    auto_increment_columns_.clear();
+    unique_columns_.clear();
+    key_columns_.clear();
+    for (size_t i = 0; i < scheme_.size(); ++i) {
+        if (scheme_[i].isAutoIncrement) {
+            auto_increment_columns_.push_back(i);
+        }
+        if (scheme_[i].isUnique) {
+            unique_columns_.push_back(i);
+        }
+        if (scheme_[i].isKey) {
+            key_columns_.push_back(i);
+            if (!indexes_.count(scheme_[i].name)) {
+                Index index;
+                index.columns = {scheme_[i].name};
+                index.offsets = {i};
+                build_index(index);
+                indexes_.emplace(scheme_[i].name, std::move(index));
+            }
+        }
+    }
 }
 
 void Table::insert_row(RowType row) {
     if (row.size() > scheme_.size()) {
         throw std::runtime_error("Number of values exceeds number of columns.");
     }
+    storage().validate(row);
+    storage().checkHeap(storage().heapBytes(row));
 
-    for (size_t i = 0; i < scheme_.size(); ++i) {
-        if (scheme_[i].isAutoIncrement) {
+    // counters are advanced only once the row is known to be valid
+    for (size_t i : auto_increment_columns_) {
+        if (!std::holds_alternative<int>(row[i])) {
+            throw std::runtime_error(
+                "AutoIncrement is only applicable to integer columns.");
+        }
+        int value = std::get<int>(row[i]);
+        if (value == 0) {
+            row[i] = auto_increment_[i];
+        } else if (value < auto_increment_[i]) {
+            throw std::runtime_error(
+                "Cannot set AUTOINCREMENT value less than current "
+                "sequence: " +
+                scheme_[i].name);
+        }
+    }
+
+    for (size_t i : unique_columns_) {
+        if (unique_values_[i].count(storedValue(scheme_[i], row[i]))) {
+            throw std::runtime_error("Unique constraint violated for column: " +
+                                     scheme_[i].name);
+        }
+    }
+    for (size_t i : key_columns_) {
+        if (indexes_.at(scheme_[i].name).orderedIndex.count(
+                encodedValue(scheme_[i], row[i]))) {
+            throw std::runtime_error("Key constraint violated for column: " +
+                                     scheme_[i].name);
+        }
+    }
+
+    for (size_t i : auto_increment_columns_) {
+        auto_increment_[i] = std::get<int>(row[i]) + 1;
+    }
+    for (size_t i : unique_columns_) {
+        unique_values_[i].insert(storedValue(scheme_[i], row[i]));
+    }
+    index_row(storage().size(), row);
+    storage().append(row);
+}
+
+void Table::insert_rows(std::vector<RowType> rows) {
+    size_t heapBytes = 0;
+    for (const auto& row : rows) {
+        if (row.size() > scheme_.size()) {
+            throw std::runtime_error(
+                "Number of values exceeds number of columns.");
+        }
+        storage().validate(row);
+        heapBytes += storage().heapBytes(row);
+    }
+    storage().checkHeap(heapBytes);
+
+    std::vector<int> counters = auto_increment_;
+    for (size_t i : auto_increment_columns_) {
+        int& counter = counters[i];
+        for (auto& row : rows) {
             if (!std::holds_alternative<int>(row[i])) {
                 throw std::runtime_error(
                     "AutoIncrement is only applicable to integer columns.");
             }
-
             int value = std::get<int>(row[i]);
             if (value == 0) {
-                row[i] = autoIncrementValues_[scheme_[i].name]++;
+                row[i] = counter++;
+            } else if (value >= counter) {
+                counter = value + 1;
             } else {
-                if (value >= autoIncrementValues_[scheme_[i].name]) {
-                    autoIncrementValues_[scheme_[i].name] = value + 1;
-                } else {
-                    throw std::runtime_error(
-                        "Cannot set AUTOINCREMENT value less than current "
-                        "sequence: " +
-                        scheme_[i].name);
-                }
+                throw std::runtime_error(
+                    "Cannot set AUTOINCREMENT value less than current "
+                    "sequence: " +
+                    scheme_[i].name);
             }
         }
     }
 
-    for (size_t i = 0; i < scheme_.size(); ++i) {
-        if (scheme_[i].isUnique) {
-            for (const auto& existing_row : rows_) {
-                if (existing_row[i] == row[i]) {
-                    throw std::runtime_error(
-                        "Unique constraint violated for column: " +
-                        scheme_[i].name);
-                }
+    for (size_t i : unique_columns_) {
+        std::unordered_set<DBType, DBTypeHash> batch;
+        batch.reserve(rows.size());
+        for (const auto& row : rows) {
+            DBType value = storedValue(scheme_[i], row[i]);
+            if (unique_values_[i].count(value) ||
+                !batch.insert(std::move(value)).second) {
+                throw std::runtime_error(
+                    "Unique constraint violated for column: " +
+                    scheme_[i].name);
             }
         }
-
-        if (scheme_[i].isKey) {
-            auto& index = indexes_[scheme_[i].name];
-            if (index.orderedIndex.count(dBTypeToString(row[i]))) {
+    }
+    for (size_t i : key_columns_) {
+        const auto& index = indexes_.at(scheme_[i].name);
+        std::unordered_set<std::string> batch;
+        for (const auto& row : rows) {
+            std::string key = encodedValue(scheme_[i], row[i]);
+            if (index.orderedIndex.count(key) ||
+                !batch.insert(std::move(key)).second) {
                 throw std::runtime_error(
                     "Key constraint violated for column: " + scheme_[i].name);
             }
-            index.orderedIndex.emplace(dBTypeToString(row[i]), rows_.size());
         }
     }
 
-    rows_.push_back(row);
+    auto_increment_ = std::move(counters);
+    storage().reserve(storage().size() + rows.size());
+    for (const auto& row : rows) {
+        index_row(storage().size(), row);
+        storage().append(row);
+    }
+    for (size_t i : unique_columns_) {
+        unique_values_[i].reserve(unique_values_[i].size() + rows.size());
+        for (const auto& row : rows) {
+            unique_values_[i].insert(storedValue(scheme_[i], row[i]));
+        }
+    }
 }
 
 void Table::addAutoIncrement(const std::string& columnName) {
@@ -219,12 +713,14 @@ void Table::addAutoIncrement(const std::string& columnName) {
             "AutoIncrement is only applicable to integer columns.");
     }
     it->isAutoIncrement = true;
-    autoIncrementValues_[columnName] = 0;
+    auto_increment_[it - scheme_.begin()] = 0;
+    plan_inserts();
 }
 
 void Table::addKeyConstraint(const std::string& columnName) {
     addUniqueConstraint(columnName);
-    indexes_[columnName] = {};
+    scheme_[column_to_row_offset_.at(columnName)].isKey = true;
+    plan_inserts();
 }
 
 void Table::createIndex(const std::string& indexTypeStr, const std::vector<std::string>& columns) {
@@ -251,20 +747,184 @@ void Table::createIndex(const std::string& indexTypeStr, const std::vector<std::
     index.type = indexType;
     index.columns = columns;
 
-    for (size_t row = 0; row < rows_.size(); ++row) {
-        if (index.type == IndexType::ORDERED) {
-            std::string key = dBTypeToString(rows_[row][column_to_row_offset_[columns[0]]]);
-            index.orderedIndex.emplace(key, row);
-        } else if (index.type == IndexType::UNORDERED) {
+    for (const auto& col : columns) {
+        index.offsets.push_back(column_to_row_offset_[col]);
+    }
+    build_index(index);
+    indexes_.emplace(columnsToKey(columns), std::move(index));
+    ++scheme_version_;
+}
+
+void Table::build_index(Index& index) const {
+    index.orderedIndex.clear();
+    index.unorderedIndex.clear();
+    if (index.type == IndexType::UNORDERED) {
+        for (size_t row = 0; row < storage().size(); ++row) {
+            if (!is_deleted(row)) {
+                index.unorderedIndex[index_key(index, get_row(row))].insert(
+                    row);
+            }
+        }
+        return;
+    }
+
+    const auto& offsets = index.offsets;
+    std::vector<std::pair<std::string, size_t>> entries;
+    entries.reserve(size());
+    const Dictionary* dictionary = storage().dictionary(offsets[0]);
+    if (offsets.size() == 1 && dictionary != nullptr) {
+        // rows are grouped by code and each distinct value is encoded and
+        // compared only while sorting the dictionary, so the entries come
+        // out in order
+        std::vector<std::vector<size_t>> rowsByCode(dictionary->size());
+        for (size_t row = 0; row < storage().size(); ++row) {
+            if (is_deleted(row)) {
+                continue;
+            }
+            uint32_t code;
+            rowsByCode[*storage().codes(offsets[0], row, 1, &code)].push_back(
+                row);
+        }
+        std::vector<std::string> keys(dictionary->size());
+        for (uint32_t code = 0; code < keys.size(); ++code) {
+            keys[code] = OrderedIndex::encode(dictionary->decode(code));
+        }
+        std::vector<uint32_t> order(dictionary->size());
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](uint32_t lhs, uint32_t rhs) {
+            return keys[lhs] < keys[rhs];
+        });
+        for (uint32_t code : order) {
+            for (size_t row : rowsByCode[code]) {
+                entries.emplace_back(keys[code], row);
+            }
+        }
+    } else {
+        for (size_t row = 0; row < storage().size(); ++row) {
+            if (is_deleted(row)) {
+                continue;
+            }
             std::string key;
-            for (const auto& col : columns) {
-                key += dBTypeToString(rows_[row][column_to_row_offset_[col]]) + "|";
+            for (size_t offset : offsets) {
+                OrderedIndex::appendKey(key, get_value(row, offset));
+            }
+            entries.emplace_back(std::move(key), row);
+        }
+        std::sort(entries.begin(), entries.end());
+    }
+    index.orderedIndex.assign(std::move(entries));
+}
+
+std::string Table::index_key(const Index& index, const RowType& row) const {
+    std::string key;
+    for (size_t offset : index.offsets) {
+        OrderedIndex::appendKey(key, storedValue(scheme_[offset], row[offset]));
+    }
+    return key;
+}
+
+void Table::index_row(size_t id, const RowType& row) {
+    for (auto& [name, index] : indexes_) {
+        if (index.type == IndexType::ORDERED) {
+            index.orderedIndex.insert(index_key(index, row), id);
+        } else {
+            index.unorderedIndex[index_key(index, row)].insert(id);
+        }
+    }
+}
+
+void Table::unindex_row(size_t id, const RowType& row) {
+    for (auto& [name, index] : indexes_) {
+        std::string key = index_key(index, row);
+        if (index.type == IndexType::ORDERED) {
+            index.orderedIndex.erase(key, id);
+            continue;
+        }
+        auto it = index.unorderedIndex.find(key);
+        if (it != index.unorderedIndex.end()) {
+            it->second.erase(id);
+            if (it->second.empty()) {
+                index.unorderedIndex.erase(it);
             }
-            index.unorderedIndex[key].insert(row);
+        }
+    }
+}
+
+bool Table::lookup_index(const calculator::CompiledExpression& predicate,
+                         calculator::SelectionVector& rows) const {
+    if (indexes_.empty()) {
+        return false;
+    }
+    // value every matching row has in a column, by offset; comparing with
+    // another type than the column's fails, which is left to the scan
+    std::vector<std::optional<DBType>> values(scheme_.size());
+    for (auto& [offset, value] : predicate.equalities()) {
+        // the alternatives of DBType follow the order of DataTypeName
+        if (value.index() == static_cast<size_t>(scheme_[offset].type)) {
+            values[offset] = std::move(value);
         }
     }
 
-    indexes_.emplace(columnsToKey(columns), index);
+    // an index fixed on all of its columns is taken first, then the one
+    // with the longest fixed prefix; hashed keys need every column
+    const Index* best = nullptr;
+    std::pair<bool, size_t> bestFit;
+    for (const auto& [name, index] : indexes_) {
+        size_t fixed = 0;
+        while (fixed < index.offsets.size() &&
+               values[index.offsets[fixed]]) {
+            ++fixed;
+        }
+        std::pair<bool, size_t> fit(fixed == index.offsets.size(), fixed);
+        if (fixed == 0 || (index.type == IndexType::UNORDERED && !fit.first)) {
+            continue;
+        }
+        if (!best || fit > bestFit) {
+            best = &index;
+            bestFit = fit;
+        }
+    }
+    if (!best) {
+        return false;
+    }
+
+    std::string key;
+    for (size_t i = 0; i < bestFit.second; ++i) {
+        OrderedIndex::appendKey(key, *values[best->offsets[i]]);
+    }
+    rows.clear();
+    if (best->type == IndexType::ORDERED) {
+        auto end = best->orderedIndex.lowerBound(OrderedIndex::prefixEnd(key));
+        for (auto it = best->orderedIndex.lowerBound(key); it != end; ++it) {
+            rows.push_back(it.row());
+        }
+    } else {
+        auto it = best->unorderedIndex.find(key);
+        if (it != best->unorderedIndex.end()) {
+            rows.assign(it->second.begin(), it->second.end());
+        }
+    }
+    std::sort(rows.begin(), rows.end());
+    ++index_lookups_;
+    return true;
+}
+
+void Table::verify_indexes() const {
+    for (const auto& [name, index] : indexes_) {
+        Index expected = index;
+        build_index(expected);
+        bool same = expected.unorderedIndex == index.unorderedIndex &&
+                    expected.orderedIndex.size() == index.orderedIndex.size();
+        auto it = index.orderedIndex.begin();
+        for (auto want = expected.orderedIndex.begin();
+             same && want != expected.orderedIndex.end(); ++want, ++it) {
+            same = want.key() == it.key() && want.row() == it.row();
+        }
+        if (!same) {
+            throw std::runtime_error("Index " + name +
+                                     " does not match the rows.");
+        }
+    }
 }
 
 std::string Table::columnsToKey(const std::vector<std::string>& columns) const {
@@ -275,12 +935,25 @@ std::string Table::columnsToKey(const std::vector<std::string>& columns) const {
     return key;
 }
 
-bool Table::useIndexForQuery(const std::string& columnName) {
-    if (indexes_.find(columnName) != indexes_.end()) {
-        std::cout << "Using index for column: " << columnName << std::endl;
-        return true;
+bool Table::useIndexForQuery(const std::string& columnName) const {
+    for (const auto& [name, index] : indexes_) {
+        if (!index.columns.empty() && index.columns.front() == columnName) {
+            return true;
+        }
     }
     return false;
 }
 
+std::vector<RowType> TableView::project(
+    const std::vector<size_t>& offsets) const {
+    std::vector<RowType> result(rows_.size());
+    for (size_t index = 0; index < rows_.size(); ++index) {
+        result[index].reserve(offsets.size());
+        for (size_t offset : offsets) {
+            result[index].push_back(table_->get_value(rows_[index], offset));
+        }
+    }
+    return result;
+}
+
 }  // namespace database
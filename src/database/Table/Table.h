@@ -9,6 +9,7 @@
 #include <functional>
 #include <iostream>
 #include <map>
+#include <memory_resource>
 #include <set>
 #include <string>
 #include <vector>
@@ -16,37 +17,97 @@
 #include <unordered_set>
 #include <variant>
 
+#include "../../Calculator/CompiledExpression.h"
 #include "../../query_language/AST/SQLStatement.h"
 #include "../../types.h"
+#include "ColumnStore.h"
+#include "OrderedIndex.h"
+#include "RowStore.h"
 
 namespace database {
 
+// Kept up to date by every insert, update and delete. KEY columns have an
+// ORDERED index named after the column.
 struct Index {
-    IndexType type;
+    IndexType type = IndexType::ORDERED;
     std::vector<std::string> columns;
+    std::vector<size_t> offsets;
 
-    std::multimap<std::string, size_t> orderedIndex;
-
+    // Keys of both kinds are the values of the columns encoded by
+    // OrderedIndex::appendKey, one after another, so that equal keys mean
+    // equal values.
+    // ORDERED and KEY indexes
+    OrderedIndex orderedIndex;
+    // UNORDERED indexes
     std::unordered_map<std::string, std::unordered_set<size_t>> unorderedIndex;
 };
 
+class TableView;
+
 class Table {
    public:
     Table() {}
 
-    Table(const std::string& name, const SchemeType& columns)
-        : name_(name), scheme_(columns) {
+    Table(const std::string& name, const SchemeType& columns,
+          StorageType storage = StorageType::ROW)
+        : name_(name), scheme_(columns), storage_(storage) {
         for (size_t i = 0; i < columns.size(); i++) {
             column_to_row_offset_[columns[i].name] = i;
         }
         row_sizes_.resize(columns.size());
+        auto_increment_.resize(columns.size());
+        unique_values_.resize(columns.size());
+        if (storage_ == StorageType::ROW) {
+            rows_ = RowStore(columns);
+        } else {
+            columns_ = ColumnStore(columns);
+        }
+        plan_inserts();
     }
 
-    size_t size() const { return rows_.size(); }
+    // Number of rows, not counting deleted ones.
+    size_t size() const { return storage().size() - deleted_count_; }
+
+    StorageType get_storage() const { return storage_; }
 
-    std::vector<RowType>& get_rows() { return rows_; }
+    // Approximate bytes taken by the rows, the deleted-row bitmap, the
+    // indexes and the UNIQUE value sets.
+    size_t memory_usage() const;
+
+    // Rows are stored packed (see RowStore and ColumnStore), so this is a
+    // view of the live rows that builds each one when it is read; nothing
+    // is copied up front. get_row and the filters read only what they need.
+    TableView get_rows() const;
+    // Ids of the rows returned by get_rows, for get_row and set_row. Deleted
+    // rows keep their ids until compact() is called.
+    std::vector<size_t> get_row_ids() const;
+    // Appends the values of the rows returned by get_rows to cells, one row
+    // after another, so that the rows take a single buffer from the
+    // allocator of cells instead of a vector each.
+    void read_rows(std::pmr::vector<DBType>& cells) const;
+
+    RowType get_row(size_t index) const;
+    void set_row(size_t index, const RowType& row);
+    // Writes rows given by id all at once: if one of them has a wrong type
+    // or breaks a UNIQUE or KEY constraint, none is written.
+    void set_rows(const std::vector<std::pair<size_t, RowType>>& rows);
+    // Throws what set_rows would throw, without writing anything.
+    void check_rows(const std::vector<std::pair<size_t, RowType>>& rows) const;
+    DBType get_value(size_t row, size_t offset) const;
+
+    bool is_deleted(size_t index) const {
+        return index < deleted_.size() && deleted_[index];
+    }
+    // Removes the deleted rows from the storage in one pass and renumbers
+    // the rows in the indexes. The remove_* calls run it once deleted rows
+    // make up half of at least kCompactMinRows stored ones; row ids,
+    // selection vectors and views taken before such a call must not be used
+    // after it.
+    void compact();
+    static constexpr size_t kCompactMinRows = 1024;
 
     SchemeType get_scheme() const { return scheme_; }
+    size_t column_count() const { return scheme_.size(); }
 
     std::map<std::string, size_t> get_column_to_row_offset() const {
         return column_to_row_offset_;
@@ -55,13 +116,18 @@ class Table {
     std::string get_name() const { return name_; }
 
     void insert_row(RowType row);
+    // Inserts all rows or none of them: constraints are checked for the
+    // whole batch before the table is modified.
+    void insert_rows(std::vector<RowType> rows);
 
     void addAutoIncrement(const std::string& columnName);
     void addUniqueConstraint(const std::string& columnName);
     void addKeyConstraint(const std::string& columnName);
+    // Incremented whenever a constraint or an index is added.
+    size_t scheme_version() const { return scheme_version_; }
 
     std::vector<RowType> filter(
-        const std::function<bool(const RowType&)>& predicate);
+        const std::function<bool(const RowType&)>& predicate) const;
 
     void update_many(
         const std::function<void(std::vector<DBType>&)>& updater,
@@ -70,7 +136,29 @@ class Table {
     void remove_many(
         const std::function<bool(const std::vector<DBType>&)>& predicate);
 
-    void drop_rows() { rows_ = {}; }
+    // Same as above, but the predicate is evaluated a block of rows at a time
+    // and the matching rows are taken from the resulting selection vector.
+    std::vector<RowType> filter(
+        const calculator::CompiledExpression& predicate) const;
+
+    void update_many(const std::function<void(std::vector<DBType>&)>& updater,
+                     const calculator::CompiledExpression& predicate);
+
+    void remove_many(const calculator::CompiledExpression& predicate);
+
+    // Ids of the rows matching the predicate (all rows for an empty one), in
+    // ascending order; deleted rows are skipped. Equalities on the leading
+    // columns of an index are looked up in it instead of scanning.
+    calculator::SelectionVector select_rows(
+        const calculator::CompiledExpression& predicate) const;
+    TableView view(const calculator::CompiledExpression& predicate) const;
+
+    // Same as update_many and remove_many for rows already selected.
+    void update_rows(const calculator::SelectionVector& rows,
+                     const std::function<void(std::vector<DBType>&)>& updater);
+    void remove_rows(const calculator::SelectionVector& rows);
+
+    void drop_rows();
 
     std::string convert_to_byte_buffer();
 
@@ -80,21 +168,122 @@ class Table {
 
     std::string columnsToKey(const std::vector<std::string>& columns) const;
 
-    bool useIndexForQuery(const std::string& columnName);
+    // True if an index starts with the column, so that equalities on it are
+    // looked up rather than scanned.
+    bool useIndexForQuery(const std::string& columnName) const;
+    // Number of select_rows calls answered from an index.
+    size_t index_lookups() const { return index_lookups_; }
 
     const std::unordered_map<std::string, Index>& getIndexes() const {
         return indexes_;
     }
+    // Throws if an index differs from one built from the stored rows.
+    void verify_indexes() const;
 
    private:
+    Storage& storage() {
+        return storage_ == StorageType::ROW ? static_cast<Storage&>(rows_)
+                                            : columns_;
+    }
+    const Storage& storage() const {
+        return storage_ == StorageType::ROW
+                   ? static_cast<const Storage&>(rows_)
+                   : columns_;
+    }
+
+    // Collects the columns insert_row has to check or fill, so that the
+    // others are not looked at; called whenever a constraint is added.
+    void plan_inserts();
+    // Writes the rows after checking the batch against the UNIQUE columns,
+    // so that either all of them are changed or none.
+    void apply_updates(const std::vector<std::pair<size_t, RowType>>& updates);
+    // The checks of apply_updates; collects the values of each UNIQUE column
+    // that leave and enter the table.
+    void check_updates(const std::vector<std::pair<size_t, RowType>>& updates,
+                       std::vector<std::vector<DBType>>& removed,
+                       std::vector<std::vector<DBType>>& added) const;
+    // Marks the rows as deleted; they are skipped by every scan and removed
+    // from the indexes.
+    void delete_rows(const std::vector<size_t>& rows);
+    // Fills index from the stored rows.
+    void build_index(Index& index) const;
+    std::string index_key(const Index& index, const RowType& row) const;
+    void index_row(size_t id, const RowType& row);
+    void unindex_row(size_t id, const RowType& row);
+    // Fills rows with the sorted ids an index gives for the equalities of
+    // the predicate; false if no index fits them.
+    bool lookup_index(const calculator::CompiledExpression& predicate,
+                      calculator::SelectionVector& rows) const;
+    void skip_deleted(calculator::SelectionVector& selection) const;
+
     std::string name_;
     SchemeType scheme_;
-    std::vector<RowType> rows_;
+    StorageType storage_ = StorageType::ROW;
+    RowStore rows_;
+    ColumnStore columns_;
+    std::vector<bool> deleted_;
+    size_t deleted_count_ = 0;
     std::vector<size_t> row_sizes_;
     std::map<std::string, size_t> column_to_row_offset_;
     std::vector<std::string> checkConditions_;
-    std::map<std::string, int> autoIncrementValues_;
+    // Next AUTOINCREMENT value of each column, by offset.
+    std::vector<int> auto_increment_;
+    std::vector<size_t> auto_increment_columns_;
+    std::vector<size_t> unique_columns_;
+    std::vector<size_t> key_columns_;
+    size_t scheme_version_ = 0;
     std::unordered_map<std::string, Index> indexes_;
+    mutable size_t index_lookups_ = 0;
+    // Values of every UNIQUE column (stored as the column type, so INT values
+    // of DOUBLE columns are converted), so that inserts and updates are
+    // checked without a scan. Empty for the other columns.
+    std::vector<std::unordered_set<DBType, DBTypeHash>> unique_values_;
+};
+
+// Rows of a table picked by a selection vector. Only the ids are kept, so a
+// view is cheap to pass around and reads just the columns asked for; it is
+// valid until rows of the table are removed (see Table::compact).
+class TableView {
+   public:
+    TableView(const Table& table, calculator::SelectionVector rows)
+        : table_(&table), rows_(std::move(rows)) {}
+
+    // Yields the rows of a view one at a time, built when dereferenced.
+    class Iterator {
+       public:
+        Iterator(const TableView* view, size_t index)
+            : view_(view), index_(index) {}
+
+        RowType operator*() const { return view_->row(index_); }
+        Iterator& operator++() {
+            ++index_;
+            return *this;
+        }
+        bool operator!=(const Iterator& other) const {
+            return index_ != other.index_;
+        }
+
+       private:
+        const TableView* view_;
+        size_t index_;
+    };
+
+    size_t size() const { return rows_.size(); }
+    const calculator::SelectionVector& row_ids() const { return rows_; }
+
+    DBType value(size_t index, size_t offset) const {
+        return table_->get_value(rows_[index], offset);
+    }
+    RowType row(size_t index) const { return table_->get_row(rows_[index]); }
+    RowType operator[](size_t index) const { return row(index); }
+    Iterator begin() const { return Iterator(this, 0); }
+    Iterator end() const { return Iterator(this, rows_.size()); }
+    // The given columns of every row, in the order of offsets.
+    std::vector<RowType> project(const std::vector<size_t>& offsets) const;
+
+   private:
+    const Table* table_;
+    calculator::SelectionVector rows_;
 };
 
 }  // namespace database
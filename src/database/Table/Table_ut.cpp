@@ -0,0 +1,744 @@
+#include <gtest/gtest.h>
+
+#include "../../Calculator/Calculator.h"
+#include "Table.h"
+
+using namespace database;
+
+class TableTest : public ::testing::Test {
+   protected:
+    TableTest()
+        : table("Test", {{"ID", DataTypeName::INT},
+                         {"Name", DataTypeName::STRING},
+                         {"Score", DataTypeName::DOUBLE}}) {}
+
+    calculator::CompiledExpression compile(const std::string& expression) {
+        return calc.compile(expression, table.get_column_to_row_offset());
+    }
+
+    calculator::Calculator calc;
+    Table table;
+};
+
+TEST_F(TableTest, FilterWithCompiledPredicate) {
+    for (int i = 0; i < 3000; ++i) {
+        table.insert_row({i, "Name" + std::to_string(i % 3), i * 0.5});
+    }
+
+    auto rows = table.filter(compile("ID >= 1000 && Name == \"Name1\""));
+    ASSERT_EQ(rows.size(), 667);
+    EXPECT_EQ(std::get<int>(rows.front()[0]), 1000);
+    EXPECT_EQ(std::get<int>(rows.back()[0]), 2998);
+
+    rows = table.filter(compile("2 > ID || Score * 2 == 2999.0"));
+    ASSERT_EQ(rows.size(), 3);
+    EXPECT_EQ(std::get<int>(rows[2][0]), 2999);
+}
+
+TEST_F(TableTest, UpdateManyWithCompiledPredicate) {
+    for (int i = 0; i < 10; ++i) {
+        table.insert_row({i, std::string("Name"), 0.0});
+    }
+
+    table.update_many([](RowType& row) { row[2] = 1.0; },
+                      compile("ID % 2 == 0"));
+    auto rows = table.filter(compile("Score == 1.0"));
+    EXPECT_EQ(rows.size(), 5);
+}
+
+TEST_F(TableTest, RemoveManyWithDuplicateRows) {
+    table.insert_row({1, std::string("A"), 1.0});
+    table.insert_row({1, std::string("A"), 1.0});
+    table.insert_row({2, std::string("B"), 2.0});
+    table.insert_row({1, std::string("A"), 1.0});
+
+    table.remove_many(compile("ID == 1"));
+    ASSERT_EQ(table.size(), 1);
+    EXPECT_EQ(std::get<int>(table.get_rows()[0][0]), 2);
+}
+
+TEST_F(TableTest, SelectedRowIdsAndViews) {
+    for (int i = 0; i < 6; ++i) {
+        table.insert_row({i, "Name" + std::to_string(i), i * 1.0});
+    }
+    auto ids = table.select_rows(compile("Score >= 2.0 && ID != 4"));
+    EXPECT_EQ(ids, (calculator::SelectionVector{2, 3, 5}));
+    EXPECT_EQ(table.select_rows(calculator::CompiledExpression()).size(), 6);
+
+    TableView view = table.view(compile("ID < 2"));
+    ASSERT_EQ(view.size(), 2);
+    EXPECT_EQ(std::get<std::string>(view.value(1, 1)), "Name1");
+    auto projected = view.project({2, 0});
+    ASSERT_EQ(projected[1].size(), 2);
+    EXPECT_EQ(std::get<double>(projected[1][0]), 1.0);
+    EXPECT_EQ(std::get<int>(projected[1][1]), 1);
+
+    // the same selection is reused for the update and the delete
+    table.update_rows(ids, [](RowType& row) { row[2] = -1.0; });
+    EXPECT_EQ(table.filter(compile("Score < 0.0")).size(), 3);
+    table.remove_rows(ids);
+    EXPECT_EQ(table.size(), 3);
+    EXPECT_EQ(table.filter(compile("Score < 0.0")).size(), 0);
+}
+
+TEST_F(TableTest, RemoveManyLeavesTombstonesUntilCompaction) {
+    for (int i = 0; i < 10; ++i) {
+        table.insert_row({i, "Name" + std::to_string(i % 2), i * 1.0});
+    }
+    table.createIndex("ordered", {"ID"});
+    table.createIndex("unordered", {"Name"});
+
+    table.remove_many(compile("ID < 2"));
+    table.remove_many([](const RowType& row) {
+        return std::get<int>(row[0]) == 5;
+    });
+    ASSERT_EQ(table.size(), 7);
+    EXPECT_TRUE(table.is_deleted(0));
+    EXPECT_TRUE(table.is_deleted(5));
+    EXPECT_EQ(table.get_rows().size(), 7);
+    EXPECT_EQ(table.get_row_ids(),
+              (std::vector<size_t>{2, 3, 4, 6, 7, 8, 9}));
+    EXPECT_EQ(table.filter(compile("ID < 6")).size(), 3);
+    EXPECT_EQ(table.filter([](const RowType&) { return true; }).size(), 7);
+    table.update_many([](RowType& row) { row[2] = 0.0; }, compile("ID < 6"));
+    EXPECT_EQ(table.filter(compile("Score == 0.0")).size(), 3);
+    EXPECT_EQ(std::get<double>(table.get_row(1)[2]), 1.0);
+
+    table.compact();
+    EXPECT_EQ(table.get_row_ids(),
+              (std::vector<size_t>{0, 1, 2, 3, 4, 5, 6}));
+    EXPECT_EQ(std::get<int>(table.get_row(3)[0]), 6);
+    const auto& ordered = table.getIndexes().at("ID,").orderedIndex;
+    ASSERT_EQ(ordered.size(), 7);
+    EXPECT_EQ(ordered.lowerBound(OrderedIndex::encode(6)).row(), 3);
+    EXPECT_EQ(ordered.count(OrderedIndex::encode(5)), 0);
+    const auto& unordered = table.getIndexes().at("Name,").unorderedIndex;
+    EXPECT_EQ(unordered.at(OrderedIndex::encode(std::string("Name1"))),
+              (std::unordered_set<size_t>{1, 4, 6}));
+
+    // a table this small is not compacted by deletes
+    table.remove_many(compile("ID < 6"));
+    EXPECT_EQ(table.size(), 4);
+    EXPECT_EQ(table.get_row_ids(), (std::vector<size_t>{3, 4, 5, 6}));
+}
+
+TEST_F(TableTest, RemoveCompactsLargeTables) {
+    const int rows = 2 * Table::kCompactMinRows;
+    for (int i = 0; i < rows; ++i) {
+        table.insert_row({i, "N" + std::to_string(i), i * 1.0});
+    }
+    table.createIndex("ordered", {"ID"});
+
+    table.remove_many(compile("ID < " + std::to_string(rows / 2 - 1)));
+    EXPECT_EQ(table.size(), rows / 2 + 1);
+    EXPECT_TRUE(table.is_deleted(0));
+
+    // deleting half of the stored rows compacts
+    table.remove_many(compile("ID == " + std::to_string(rows / 2 - 1)));
+    EXPECT_EQ(table.size(), rows / 2);
+    EXPECT_FALSE(table.is_deleted(0));
+    EXPECT_EQ(table.get_row_ids().back(), rows / 2 - 1);
+    EXPECT_EQ(std::get<int>(table.get_row(0)[0]), rows / 2);
+    EXPECT_NO_THROW(table.verify_indexes());
+}
+
+TEST_F(TableTest, RemoveRowsSkipsDeletedAndRepeatedIds) {
+    for (int i = 0; i < 10; ++i) {
+        table.insert_row({i, "N" + std::to_string(i), i * 1.0});
+    }
+    table.addUniqueConstraint("Name");
+    table.createIndex("ordered", {"ID"});
+
+    calculator::SelectionVector selection = {1, 2};
+    table.remove_rows(selection);
+    table.remove_rows(selection);
+    EXPECT_EQ(table.size(), 8);
+    EXPECT_NO_THROW(table.verify_indexes());
+
+    // the value of a deleted row now belongs to a live one, which a stale
+    // id of the deleted row must not release
+    table.insert_row({10, std::string("N1"), 10.0});
+    table.remove_rows({1});
+    EXPECT_EQ(table.size(), 9);
+    EXPECT_THROW(table.insert_row({11, std::string("N1"), 11.0}),
+                 std::runtime_error);
+
+    table.remove_rows({3, 3});
+    EXPECT_EQ(table.size(), 8);
+    EXPECT_TRUE(table.is_deleted(3));
+    EXPECT_EQ(table.get_rows().size(), 8);
+    EXPECT_NO_THROW(table.verify_indexes());
+}
+
+TEST_F(TableTest, UniqueValuesFollowInsertUpdateAndDelete) {
+    table.insert_row({1, std::string("A"), 1.0});
+    table.insert_row({2, std::string("B"), 2.0});
+    table.insert_row({3, std::string("B"), 3.0});
+    EXPECT_THROW(table.addUniqueConstraint("Name"), std::runtime_error);
+    table.remove_many(compile("ID == 3"));
+    table.addUniqueConstraint("Name");
+    table.addUniqueConstraint("Score");
+
+    EXPECT_THROW(table.insert_row({4, std::string("A"), 4.0}),
+                 std::runtime_error);
+    // INT values of DOUBLE columns are compared as stored
+    EXPECT_THROW(table.insert_row({4, std::string("D"), 2}),
+                 std::runtime_error);
+
+    // a batch that moves values between rows is accepted, one that
+    // duplicates a value changes nothing
+    table.update_many(
+        [](RowType& row) {
+            row[1] = std::string(std::get<int>(row[0]) == 1 ? "B" : "A");
+        },
+        compile("ID <= 2"));
+    EXPECT_EQ(std::get<std::string>(table.get_rows()[0][1]), "B");
+    EXPECT_THROW(
+        table.update_many([](RowType& row) { row[1] = std::string("C"); },
+                          compile("ID <= 2")),
+        std::runtime_error);
+    EXPECT_EQ(std::get<std::string>(table.get_rows()[1][1]), "A");
+    EXPECT_THROW(table.set_row(0, {1, std::string("A"), 1.0}),
+                 std::runtime_error);
+
+    table.remove_many(compile("ID == 1"));
+    table.insert_row({5, std::string("B"), 1});
+    EXPECT_EQ(table.size(), 2);
+
+    for (int i = 0; i < 20000; ++i) {
+        table.insert_row({i + 10, "Name" + std::to_string(i), i + 10.0});
+    }
+    EXPECT_THROW(table.insert_rows({{0, std::string("Name19999"), 0.5}}),
+                 std::runtime_error);
+    EXPECT_EQ(table.size(), 20002);
+}
+
+TEST_F(TableTest, InsertRowsIsAtomic) {
+    table.addAutoIncrement("ID");
+    table.addUniqueConstraint("Name");
+    table.insert_row({0, std::string("A"), 1.0});
+
+    table.insert_rows({{0, std::string("B"), 2.0},
+                       {10, std::string("C"), 3.0},
+                       {0, std::string("D"), 4.0}});
+    ASSERT_EQ(table.size(), 4);
+    EXPECT_EQ(std::get<int>(table.get_rows()[1][0]), 1);
+    EXPECT_EQ(std::get<int>(table.get_rows()[3][0]), 11);
+
+    EXPECT_THROW(table.insert_rows({{0, std::string("E"), 5.0},
+                                    {0, std::string("E"), 6.0}}),
+                 std::runtime_error);
+    EXPECT_THROW(table.insert_rows({{0, std::string("A"), 5.0}}),
+                 std::runtime_error);
+    EXPECT_EQ(table.size(), 4);
+
+    table.insert_row({0, std::string("E"), 5.0});
+    EXPECT_EQ(std::get<int>(table.get_rows()[4][0]), 12);
+}
+
+TEST(ColumnarTableTest, FilterUpdateAndRemove) {
+    Table table("Test",
+                {{"ID", DataTypeName::INT},
+                 {"Name", DataTypeName::STRING},
+                 {"Score", DataTypeName::DOUBLE},
+                 {"Active", DataTypeName::BOOL}},
+                StorageType::COLUMNAR);
+    for (int i = 0; i < 3000; ++i) {
+        table.insert_row({i, "Name" + std::to_string(i % 3), i * 0.5,
+                          i % 2 == 0});
+    }
+    EXPECT_THROW(table.insert_row({1, 2, 3.0, true}), std::runtime_error);
+    ASSERT_EQ(table.size(), 3000);
+
+    calculator::Calculator calc;
+    auto offsets = table.get_column_to_row_offset();
+    auto compile = [&](const std::string& expression) {
+        return calc.compile(expression, offsets);
+    };
+
+    auto rows = table.filter(compile("ID >= 1000 && Name == \"Name1\""));
+    ASSERT_EQ(rows.size(), 667);
+    EXPECT_EQ(std::get<int>(rows.front()[0]), 1000);
+    EXPECT_EQ(std::get<std::string>(rows.back()[1]), "Name1");
+    EXPECT_EQ(table.filter(compile("Active == true && ID < 10")).size(), 5);
+    rows = table.filter(compile("ID % 1000 == 0 && Score >= 1000.0"));
+    EXPECT_EQ(rows.size(), 1);
+
+    table.update_many([](RowType& row) { row[2] = 1; },
+                      compile("Name == \"Name2\""));
+    EXPECT_EQ(table.filter(compile("Score == 1.0")).size(), 1000);
+
+    table.remove_many(compile("Active == false"));
+    ASSERT_EQ(table.size(), 1500);
+    EXPECT_EQ(std::get<int>(table.get_row(1)[0]), 2);
+    EXPECT_EQ(table.get_rows().size(), 1500);
+}
+
+TEST(TableMemoryTest, UsageFollowsRowsAndIndexes) {
+    SchemeType scheme = {{"ID", DataTypeName::INT},
+                         {"Name", DataTypeName::STRING}};
+    for (StorageType storage : {StorageType::ROW, StorageType::COLUMNAR}) {
+        Table table("Test", scheme, storage);
+        size_t empty = table.memory_usage();
+
+        std::vector<RowType> batch;
+        for (int i = 0; i < 1000; ++i) {
+            batch.push_back({i, "name" + std::to_string(i % 10)});
+        }
+        table.insert_rows(std::move(batch));
+        size_t filled = table.memory_usage();
+        EXPECT_GT(filled, empty + 1000 * sizeof(int));
+
+        table.createIndex("ordered", {"ID"});
+        size_t indexed = table.memory_usage();
+        EXPECT_GT(indexed, filled + 1000 * sizeof(size_t));
+
+        table.drop_rows();
+        EXPECT_LT(table.memory_usage(), filled);
+    }
+}
+
+TEST(ZoneMapTest, RowGroupsAreSkippedByRange) {
+    const int rows = 2 * Storage::kRowGroupSize + 100;
+    SchemeType scheme = {{"ID", DataTypeName::INT},
+                         {"Score", DataTypeName::DOUBLE}};
+    calculator::Calculator calc;
+    auto compile = [&](const std::string& expression) {
+        return calc.compile(expression, {{"ID", 0}, {"Score", 1}});
+    };
+
+    ColumnStore store(scheme);
+    for (int i = 0; i < rows; ++i) {
+        store.append({i, i % 100});
+    }
+    ASSERT_EQ(store.groupCount(), 3);
+    EXPECT_EQ(std::get<int>(store.zoneMap(1)[0].min), 65536);
+    EXPECT_EQ(std::get<double>(store.zoneMap(2)[1].max), 99.0);
+    auto range = compile("ID >= 70000 && ID < 70010");
+    EXPECT_FALSE(range.mayMatch(store.zoneMap(0)));
+    EXPECT_TRUE(range.mayMatch(store.zoneMap(1)));
+    EXPECT_FALSE(range.mayMatch(store.zoneMap(2)));
+
+    for (StorageType storage : {StorageType::ROW, StorageType::COLUMNAR}) {
+        Table table("Test", scheme, storage);
+        std::vector<RowType> batch;
+        batch.reserve(rows);
+        for (int i = 0; i < rows; ++i) {
+            batch.push_back({i, i % 100});
+        }
+        table.insert_rows(std::move(batch));
+
+        auto ids = table.select_rows(range);
+        ASSERT_EQ(ids.size(), 10);
+        EXPECT_EQ(ids.front(), 70000);
+        EXPECT_EQ(table.filter(compile("ID > 131070")).size(), 101);
+        EXPECT_EQ(table.filter(compile("Score > 98.5")).size(), 1311);
+
+        // ranges grow with updates and are recomputed when rows are erased
+        table.update_many([](RowType& row) { row[0] = 1000000; },
+                          compile("ID == 5"));
+        EXPECT_EQ(table.filter(compile("ID == 1000000")).size(), 1);
+        table.remove_many(compile("ID < 100000"));
+        EXPECT_EQ(table.size(), rows - 99999);
+        EXPECT_EQ(table.filter(compile("ID == 100000")).size(), 1);
+        EXPECT_EQ(table.filter(compile("ID < 100000")).size(), 0);
+    }
+}
+
+TEST(RowStoreTest, PackedRecordsAndStringHeap) {
+    RowStore store({{"ID", DataTypeName::INT},
+                    {"Name", DataTypeName::STRING},
+                    {"Score", DataTypeName::DOUBLE},
+                    {"Active", DataTypeName::BOOL},
+                    {"Data", DataTypeName::BYTEBUFFER},
+                    {"Admin", DataTypeName::BOOL}});
+    EXPECT_EQ(store.recordSize(), 4 + 8 + 8 + 8 + 1);
+
+    for (int i = 0; i < 100; ++i) {
+        store.append({i, "Name" + std::to_string(i), 2, i % 2 == 0,
+                      bytebuffer{'a', static_cast<char>(i)}, i % 3 == 0});
+    }
+    EXPECT_THROW(store.append({1, 2, 3.0, true, bytebuffer{}, false}),
+                 std::runtime_error);
+    ASSERT_EQ(store.size(), 100);
+
+    RowType row = store.row(3);
+    EXPECT_EQ(std::get<std::string>(row[1]), "Name3");
+    EXPECT_EQ(std::get<double>(row[2]), 2.0);
+    EXPECT_FALSE(std::get<bool>(row[3]));
+    EXPECT_EQ(std::get<bytebuffer>(row[4]), (bytebuffer{'a', 3}));
+    EXPECT_TRUE(std::get<bool>(row[5]));
+
+    // replaced strings are dropped from the heap once they take half of it
+    for (int round = 0; round < 10; ++round) {
+        for (size_t i = 0; i < store.size(); ++i) {
+            RowType updated = store.row(i);
+            updated[1] = "Renamed" + std::to_string(round);
+            updated[3] = true;
+            store.setRow(i, updated);
+        }
+    }
+    EXPECT_LE(store.heapSize(), 2 * (100 * 8 + 100 * 2));
+    EXPECT_EQ(std::get<std::string>(store.value(1, 99)), "Renamed9");
+    EXPECT_TRUE(std::get<bool>(store.value(3, 99)));
+    EXPECT_FALSE(std::get<bool>(store.value(5, 98)));
+
+    store.erase({0, 1, 50});
+    ASSERT_EQ(store.size(), 97);
+    EXPECT_EQ(std::get<int>(store.value(0, 0)), 2);
+    EXPECT_EQ(std::get<int>(store.value(0, 48)), 51);
+    EXPECT_EQ(std::get<bytebuffer>(store.value(4, 48)), (bytebuffer{'a', 51}));
+}
+
+TEST(DictionaryTest, EncodedColumnsInBothStorages) {
+    ColumnDefinition status{"Status", DataTypeName::STRING};
+    status.isDictionary = true;
+    for (StorageType storage : {StorageType::ROW, StorageType::COLUMNAR}) {
+        Table table("Test", {{"ID", DataTypeName::INT}, status}, storage);
+        const char* statuses[] = {"new", "open", "closed"};
+        for (int i = 0; i < 2000; ++i) {
+            table.insert_row({i, std::string(statuses[i % 3])});
+        }
+
+        calculator::Calculator calc;
+        auto offsets = table.get_column_to_row_offset();
+        auto compile = [&](const std::string& expression) {
+            return calc.compile(expression, offsets);
+        };
+        EXPECT_EQ(table.filter(compile("Status == \"open\"")).size(), 667);
+        EXPECT_EQ(table.filter(compile("Status != \"open\"")).size(), 1333);
+        EXPECT_EQ(table.filter(compile("Status == \"gone\"")).size(), 0);
+        EXPECT_EQ(table.filter(compile("Status != \"gone\"")).size(), 2000);
+        auto rows = table.filter(
+            compile("ID < 10 && (Status == \"new\" || Status == \"closed\")"));
+        ASSERT_EQ(rows.size(), 7);
+        EXPECT_EQ(std::get<std::string>(rows[1][1]), "closed");
+
+        table.update_many([](RowType& row) { row[1] = std::string("gone"); },
+                          compile("Status == \"new\""));
+        EXPECT_EQ(table.filter(compile("Status == \"gone\"")).size(), 667);
+        EXPECT_EQ(table.filter(compile("Status == \"new\"")).size(), 0);
+
+        table.createIndex("ordered", {"Status"});
+        const auto& index = table.getIndexes().at("Status,").orderedIndex;
+        auto key = [](const char* value) {
+            return OrderedIndex::encode(std::string(value));
+        };
+        ASSERT_EQ(index.size(), 2000);
+        EXPECT_EQ(index.begin().key(), key("closed"));
+        EXPECT_EQ(index.begin().row(), 2);
+        EXPECT_EQ(index.count(key("gone")), 667);
+        EXPECT_GT(index.count(key("open")), 0);
+        EXPECT_EQ(index.upperBound(key("open")), index.end());
+    }
+}
+
+TEST(IndexMaintenanceTest, IndexesFollowEveryMutation) {
+    calculator::Calculator calc;
+    for (StorageType storage : {StorageType::ROW, StorageType::COLUMNAR}) {
+        SchemeType scheme = {{"ID", DataTypeName::INT},
+                             {"Group", DataTypeName::STRING},
+                             {"Score", DataTypeName::DOUBLE}};
+        scheme[0].isKey = true;
+        Table table("Test", scheme, storage);
+        auto compile = [&](const std::string& expression) {
+            return calc.compile(expression, table.get_column_to_row_offset());
+        };
+        for (int i = 0; i < 200; ++i) {
+            table.insert_row({i, "g" + std::to_string(i % 7), i % 10});
+        }
+        table.createIndex("ordered", {"Group", "Score"});
+        table.createIndex("unordered", {"Group"});
+        table.createIndex("ordered", {"Score"});
+        ASSERT_NO_THROW(table.verify_indexes());
+
+        std::vector<RowType> batch;
+        for (int i = 200; i < 300; ++i) {
+            batch.push_back({i, std::string("g0"), 0.5});
+        }
+        table.insert_rows(std::move(batch));
+        EXPECT_NO_THROW(table.verify_indexes());
+
+        table.update_many([](RowType& row) { row[2] = 7; },
+                          compile("Score < 2.0"));
+        EXPECT_NO_THROW(table.verify_indexes());
+        table.update_many(
+            [](RowType& row) { row[1] = std::string("moved"); },
+            [](const RowType& row) { return std::get<int>(row[0]) % 5 == 0; });
+        EXPECT_NO_THROW(table.verify_indexes());
+
+        table.remove_many(compile("ID < 40"));
+        EXPECT_NO_THROW(table.verify_indexes());
+        // a deleted KEY value can be inserted again right away
+        table.insert_row({3, std::string("g3"), 3.0});
+        EXPECT_THROW(table.insert_row({3, std::string("g3"), 3.0}),
+                     std::runtime_error);
+        EXPECT_NO_THROW(table.verify_indexes());
+
+        // moving a KEY value onto another live row is rejected
+        EXPECT_THROW(table.update_many([](RowType& row) { row[0] = 100; },
+                                       compile("ID == 101")),
+                     std::runtime_error);
+        table.update_many([](RowType& row) { row[0] = 1000; },
+                          compile("ID == 101"));
+        EXPECT_NO_THROW(table.verify_indexes());
+
+        table.remove_many(compile("ID >= 150"));
+        table.compact();
+        EXPECT_NO_THROW(table.verify_indexes());
+        const auto& scores = table.getIndexes().at("Score,").orderedIndex;
+        EXPECT_EQ(scores.size(), table.size());
+        EXPECT_EQ(scores.count(OrderedIndex::encode(7.0)),
+                  table.filter(compile("Score == 7.0")).size());
+        const auto& groups = table.getIndexes().at("Group,").unorderedIndex;
+        EXPECT_EQ(groups.at(OrderedIndex::encode(std::string("moved"))).size(),
+                  table.filter(compile("Group == \"moved\"")).size());
+
+        table.drop_rows();
+        EXPECT_EQ(scores.size(), 0);
+        EXPECT_NO_THROW(table.verify_indexes());
+    }
+}
+
+TEST(IndexLookupTest, EqualitiesUseIndexesAndMatchScans) {
+    calculator::Calculator calc;
+    SchemeType scheme = {{"ID", DataTypeName::INT},
+                         {"Group", DataTypeName::STRING},
+                         {"Score", DataTypeName::DOUBLE}};
+    Table plain("Plain", scheme, StorageType::COLUMNAR);
+    scheme[0].isKey = true;
+    Table indexed("Indexed", scheme, StorageType::COLUMNAR);
+    for (int i = 0; i < 3000; ++i) {
+        RowType row = {i, "g" + std::to_string(i % 7), i % 10};
+        plain.insert_row(row);
+        indexed.insert_row(row);
+    }
+    indexed.createIndex("ordered", {"Group", "Score"});
+    indexed.createIndex("unordered", {"Score"});
+    auto compile = [&](const Table& table, const std::string& expression) {
+        return calc.compile(expression, table.get_column_to_row_offset());
+    };
+    auto expectSameRows = [&](const std::string& expression, bool lookup) {
+        size_t lookups = indexed.index_lookups();
+        EXPECT_EQ(indexed.filter(compile(indexed, expression)),
+                  plain.filter(compile(plain, expression)))
+            << expression;
+        EXPECT_EQ(indexed.index_lookups(), lookups + (lookup ? 1 : 0))
+            << expression;
+    };
+
+    expectSameRows("ID == 1234", true);
+    expectSameRows("17 == ID && Score > 5.0", true);
+    expectSameRows("Group == \"g3\"", true);
+    expectSameRows("Group == \"g3\" && Score == 3.0", true);
+    expectSameRows("Score == 4.0 && ID < 100", true);
+    expectSameRows("Group == \"none\"", true);
+    expectSameRows("ID + 0 == 5", false);
+    expectSameRows("ID == 5 || Score == 1.0", false);
+    expectSameRows("Score >= 4.0", false);
+    EXPECT_THROW(indexed.filter(compile(indexed, "Score == 4")),
+                 std::invalid_argument);
+    EXPECT_TRUE(indexed.useIndexForQuery("Group"));
+    EXPECT_FALSE(plain.useIndexForQuery("Group"));
+
+    for (Table* table : {&plain, &indexed}) {
+        table->update_many([](RowType& row) { row[2] = -1.0; },
+                           compile(*table, "Group == \"g2\" && ID % 2 == 0"));
+        table->remove_many(compile(*table, "Score == 9.0"));
+        table->remove_many(compile(*table, "ID == 42"));
+    }
+    EXPECT_NO_THROW(indexed.verify_indexes());
+    expectSameRows("Score == -1.0", true);
+    expectSameRows("Group == \"g2\"", true);
+    EXPECT_EQ(indexed.filter(compile(indexed, "ID == 49")).size(), 0);
+    EXPECT_EQ(indexed.size(), plain.size());
+}
+
+TEST(IndexLookupTest, UnorderedKeysKeepTuplesApart) {
+    calculator::Calculator calc;
+    Table table("Test",
+                {{"A", DataTypeName::STRING}, {"B", DataTypeName::STRING}});
+    table.insert_row({std::string("a|b"), std::string("c")});
+    table.insert_row({std::string("a"), std::string("b|c")});
+    table.createIndex("unordered", {"A", "B"});
+
+    EXPECT_EQ(table.getIndexes().at("A,B,").unorderedIndex.size(), 2);
+    auto rows = table.select_rows(calc.compile(
+        "A == \"a\" && B == \"b|c\"", table.get_column_to_row_offset()));
+    EXPECT_EQ(rows, (calculator::SelectionVector{1}));
+    EXPECT_EQ(table.index_lookups(), 1);
+}
+
+TEST(OrderedIndexTest, TypedKeysAndRangeScans) {
+    auto key = [](const DBType& value) { return OrderedIndex::encode(value); };
+    EXPECT_LT(key(9), key(10));
+    EXPECT_LT(key(-10), key(-9));
+    EXPECT_LT(key(-1), key(0));
+    EXPECT_LT(key(-2.5), key(-0.5));
+    EXPECT_LT(key(-0.5), key(0.25));
+    EXPECT_EQ(key(0.0), key(-0.0));
+    EXPECT_LT(key(false), key(true));
+    EXPECT_LT(key(std::string("ab")), key(std::string("abc")));
+    EXPECT_LT(key(std::string("a")), key(std::string("a") + '\0'));
+    // the first column of a composite key decides the order
+    std::string shortFirst = key(std::string("a")) + key(std::string("z"));
+    std::string longFirst = key(std::string("ab")) + key(std::string("a"));
+    EXPECT_LT(shortFirst, longFirst);
+
+    // entries inserted out of order, with duplicates, come out sorted
+    OrderedIndex index;
+    const int kCount = 10000;
+    for (int i = 0; i < kCount; ++i) {
+        int value = (i * 7919) % kCount - kCount / 2;
+        index.insert(key(value / 2), i);
+    }
+    ASSERT_EQ(index.size(), kCount);
+    size_t seen = 0;
+    std::string previous;
+    for (auto it = index.begin(); it != index.end(); ++it, ++seen) {
+        EXPECT_LE(previous, it.key());
+        previous = it.key();
+    }
+    EXPECT_EQ(seen, kCount);
+    EXPECT_EQ(index.count(key(-3)), 2);
+    EXPECT_EQ(index.lowerBound(key(-kCount)).key(), key(-kCount / 4));
+
+    // range scan [-10, 10): two values halve to each key, three to 0
+    size_t inRange = 0;
+    for (auto it = index.lowerBound(key(-10)); it != index.lowerBound(key(10));
+         ++it) {
+        ++inRange;
+    }
+    EXPECT_EQ(inRange, 41);
+
+    for (int i = 0; i < kCount; i += 2) {
+        int value = (i * 7919) % kCount - kCount / 2;
+        EXPECT_TRUE(index.erase(key(value / 2), i));
+    }
+    EXPECT_FALSE(index.erase(key(0), kCount));
+    EXPECT_EQ(index.size(), kCount / 2);
+    seen = 0;
+    for (auto it = index.begin(); it != index.end(); ++it) {
+        EXPECT_EQ(it.row() % 2, 1);
+        ++seen;
+    }
+    EXPECT_EQ(seen, kCount / 2);
+
+    // composite index: prefix scans on the first column
+    SchemeType scheme = {{"City", DataTypeName::STRING},
+                         {"Age", DataTypeName::INT}};
+    Table table("People", scheme);
+    for (int i = 0; i < 300; ++i) {
+        table.insert_row({std::string(i % 3 == 0 ? "Oslo" : "Rome"), 100 - i});
+    }
+    table.createIndex("ordered", {"City", "Age"});
+    const auto& people = table.getIndexes().at("City,Age,").orderedIndex;
+    std::string oslo = key(std::string("Oslo"));
+    std::vector<int> ages;
+    for (auto it = people.lowerBound(oslo);
+         it != people.lowerBound(OrderedIndex::prefixEnd(oslo)); ++it) {
+        ages.push_back(std::get<int>(table.get_value(it.row(), 1)));
+    }
+    ASSERT_EQ(ages.size(), 100);
+    EXPECT_TRUE(std::is_sorted(ages.begin(), ages.end()));
+    EXPECT_EQ(ages.front(), -197);
+    EXPECT_EQ(people.count(oslo + key(100)), 1);
+}
+
+TEST(IntColumnTest, CompressedSegments) {
+    const size_t kSize = 3 * IntColumn::kSegmentSize + 100;
+    IntColumn ids;
+    IntColumn sorted;
+    IntColumn small;
+    std::vector<int> expected(kSize);
+    for (size_t i = 0; i < kSize; ++i) {
+        ids.push_back(static_cast<int>(i) + 1);
+        sorted.push_back(static_cast<int>(i / 1000));
+        expected[i] = static_cast<int>(i * 7919 % 100) - 50;
+        small.push_back(expected[i]);
+    }
+    EXPECT_EQ(ids.encoding(0), IntColumn::Encoding::DELTA);
+    EXPECT_EQ(sorted.encoding(1), IntColumn::Encoding::RLE);
+    EXPECT_EQ(small.encoding(2), IntColumn::Encoding::BITPACKED);
+    EXPECT_EQ(small.encoding(3), IntColumn::Encoding::PLAIN);
+    // only the plain last segment takes space
+    EXPECT_EQ(ids.memoryUsage(), 100 * sizeof(int));
+    EXPECT_LT(small.memoryUsage(), kSize * sizeof(int) / 4);
+
+    // reads and comparisons that cross segment boundaries
+    int buffer[calculator::kBatchSize];
+    size_t begin = IntColumn::kSegmentSize - 500;
+    const int* values = small.read(begin, calculator::kBatchSize, buffer);
+    for (size_t i = 0; i < calculator::kBatchSize; ++i) {
+        ASSERT_EQ(values[i], expected[begin + i]);
+    }
+    EXPECT_EQ(ids.get(2 * IntColumn::kSegmentSize + 7),
+              2 * IntColumn::kSegmentSize + 8);
+    EXPECT_EQ(sorted.get(4500), 4);
+
+    using calculator::Opcode;
+    uint8_t mask[calculator::kBatchSize];
+    for (Opcode op : {Opcode::EQUAL, Opcode::NOT_EQUAL, Opcode::LESS,
+                      Opcode::LESS_EQUAL, Opcode::GREATER,
+                      Opcode::GREATER_EQUAL}) {
+        for (int constant : {-51, -50, 0, 17, 49, 60}) {
+            ASSERT_TRUE(small.compare(op, constant, begin,
+                                      calculator::kBatchSize, mask));
+            for (size_t i = 0; i < calculator::kBatchSize; ++i) {
+                int value = expected[begin + i];
+                bool result = op == Opcode::EQUAL        ? value == constant
+                              : op == Opcode::NOT_EQUAL  ? value != constant
+                              : op == Opcode::LESS       ? value < constant
+                              : op == Opcode::LESS_EQUAL ? value <= constant
+                              : op == Opcode::GREATER    ? value > constant
+                                                         : value >= constant;
+                ASSERT_EQ(mask[i] != 0, result);
+            }
+        }
+    }
+    ASSERT_TRUE(sorted.compare(Opcode::EQUAL, 4, 3500, 1024, mask));
+    EXPECT_EQ(std::count(mask, mask + 1024, 1), 524);
+    EXPECT_FALSE(sorted.compare(Opcode::ADD, 4, 0, 1024, mask));
+
+    // changed segments are plain until compressed again
+    small.set(10, 1000);
+    EXPECT_EQ(small.encoding(0), IntColumn::Encoding::PLAIN);
+    small.compress();
+    EXPECT_EQ(small.encoding(0), IntColumn::Encoding::BITPACKED);
+    EXPECT_EQ(small.get(10), 1000);
+
+    ids.erase({0, 5000});
+    ASSERT_EQ(ids.size(), kSize - 2);
+    EXPECT_EQ(ids.get(0), 2);
+    EXPECT_EQ(ids.get(5000), 5003);
+    EXPECT_EQ(ids.encoding(0), IntColumn::Encoding::DELTA);
+}
+
+TEST(ColumnarTableTest, FilterOnCompressedColumns) {
+    Table table("Test",
+                {{"ID", DataTypeName::INT},
+                 {"Bucket", DataTypeName::INT},
+                 {"Active", DataTypeName::BOOL}},
+                StorageType::COLUMNAR);
+    for (int i = 0; i < 10000; ++i) {
+        table.insert_row({i, i / 100, i % 1000 < 10});
+    }
+    calculator::Calculator calc;
+    auto offsets = table.get_column_to_row_offset();
+    auto compile = [&](const std::string& expression) {
+        return calc.compile(expression, offsets);
+    };
+    EXPECT_EQ(table.filter(compile("ID >= 9990")).size(), 10);
+    EXPECT_EQ(table.filter(compile("Bucket == 42")).size(), 100);
+    EXPECT_EQ(table.filter(compile("Active == true")).size(), 100);
+    EXPECT_EQ(table.filter(compile("Active == false && Bucket < 10")).size(),
+              990);
+
+    table.update_many([](RowType& row) { row[2] = true; },
+                      compile("Bucket == 42"));
+    EXPECT_EQ(table.filter(compile("Active == true")).size(), 200);
+    table.remove_many(compile("ID < 5000"));
+    auto rows = table.filter(compile("ID == 5000"));
+    ASSERT_EQ(rows.size(), 1);
+    EXPECT_EQ(std::get<int>(rows[0][1]), 50);
+}
@@ -39,6 +39,11 @@ enum class IndexType {
     UNORDERED
 };
 
+enum class StorageType {
+    ROW,
+    COLUMNAR
+};
+
 class SQLStatement {
    public:
     virtual ~SQLStatement() = default;
@@ -49,9 +54,13 @@ class CreateTableStatement : public SQLStatement {
    public:
     std::string tableName;
     SchemeType columns;
+    StorageType storage = StorageType::ROW;
 
     std::string toString() const override {
-        std::string result = "CREATE TABLE " + tableName + " (";
+        std::string result =
+            std::string(storage == StorageType::COLUMNAR ? "CREATE COLUMNAR "
+                                                         : "CREATE ") +
+            "TABLE " + tableName + " (";
         for (size_t i = 0; i < columns.size(); ++i) {
             result += columns[i].toString();
             if (i != columns.size() - 1) {
@@ -67,19 +76,31 @@ class InsertStatement : public SQLStatement {
    public:
     std::string tableName;
     std::vector<std::string> values;
+    // Tuples after the first one in INSERT ... VALUES (...), (...)
+    std::vector<std::vector<std::string>> moreValues;
     std::unordered_map<std::string, std::string> columnValuePairs;
     bool isMapFormat = false;
 
     std::string toString() const override {
-        std::string result = "INSERT INTO " + tableName + " VALUES (";
-        for (size_t i = 0; i < values.size(); ++i) {
-            result += values[i];
-            if (i != values.size() - 1) {
+        std::string result = "INSERT INTO " + tableName + " VALUES " +
+                             tupleToString(values);
+        for (const auto& tuple : moreValues) {
+            result += ", " + tupleToString(tuple);
+        }
+        result += ";";
+        return result;
+    }
+
+   private:
+    static std::string tupleToString(const std::vector<std::string>& tuple) {
+        std::string result = "(";
+        for (size_t i = 0; i < tuple.size(); ++i) {
+            result += tuple[i];
+            if (i != tuple.size() - 1) {
                 result += ", ";
             }
         }
-        result += ");";
-        return result;
+        return result + ")";
     }
 };
 
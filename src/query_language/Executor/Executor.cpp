@@ -4,7 +4,10 @@
 
 #include "Executor.h"
 
+#include <cctype>
 #include <memory>
+#include <memory_resource>
+#include <optional>
 #include <regex>
 #include <string>
 #include <unordered_map>
@@ -19,549 +22,898 @@
 
 namespace database {
 
-Result Executor::execute(std::shared_ptr<SQLStatement> stmt) {
-    Result result = {};
-    try {
-        calculator::Calculator calc;
-        if (const auto *createStmt =
-                dynamic_cast<const CreateTableStatement *>(stmt.get())) {
-            m_database.createTable(createStmt->tableName, createStmt->columns);
-        } else if (const auto *insertStmt =
-                       dynamic_cast<const InsertStatement *>(stmt.get())) {
-            const auto &table = m_database.getTable(insertStmt->tableName);
-            const auto &columns = table.get_scheme();
-            auto offsets = table.get_column_to_row_offset();
+void PreparedStatement::bind(size_t index, DBType value) {
+    if (index == 0 || index > parameters_.size()) {
+        throw std::out_of_range("Parameter index out of range: " +
+                                std::to_string(index));
+    }
+    parameters_[index - 1] = std::move(value);
+    bound_[index - 1] = true;
+}
+
+PreparedStatement *PlanCache::find(const std::string &key,
+                                   size_t catalogVersion) {
+    if (catalogVersion != catalogVersion_) {
+        clear();
+        catalogVersion_ = catalogVersion;
+    }
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++misses_;
+        return nullptr;
+    }
+    ++hits_;
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return &it->second->second;
+}
+
+PreparedStatement &PlanCache::insert(const std::string &key,
+                                     PreparedStatement statement) {
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        entries_.erase(it->second);
+        index_.erase(it);
+    }
+    entries_.emplace_front(key, std::move(statement));
+    index_[key] = entries_.begin();
+    while (entries_.size() > capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+    return entries_.front().second;
+}
 
-            if (!insertStmt->isMapFormat) {
-                if (insertStmt->values.size() > columns.size()) {
+void PlanCache::clear() {
+    entries_.clear();
+    index_.clear();
+}
+
+void PlanCache::setCapacity(size_t capacity) {
+    capacity_ = capacity;
+    while (entries_.size() > capacity_) {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+    }
+}
+
+// Value of a column of the given type given as NULL.
+DBType zeroValue(DataTypeName type) {
+    switch (type) {
+        case DataTypeName::DOUBLE:
+            return 0.0;
+        case DataTypeName::BOOL:
+            return false;
+        case DataTypeName::STRING:
+            return std::string();
+        case DataTypeName::BYTEBUFFER:
+            return bytebuffer();
+        default:
+            return 0;
+    }
+}
+
+bool hasType(const DBType &value, DataTypeName type) {
+    switch (type) {
+        case DataTypeName::INT:
+            return std::holds_alternative<int>(value);
+        case DataTypeName::DOUBLE:
+            return std::holds_alternative<double>(value);
+        case DataTypeName::BOOL:
+            return std::holds_alternative<bool>(value);
+        case DataTypeName::STRING:
+            return std::holds_alternative<std::string>(value);
+        case DataTypeName::BYTEBUFFER:
+            return std::holds_alternative<bytebuffer>(value);
+    }
+    return false;
+}
+
+void Executor::compile(PreparedStatement &prepared) {
+    calculator::Calculator calc;
+    const calculator::ColumnBinding noColumns;
+    const SQLStatement *stmt = prepared.statement_.get();
+    prepared.values_.clear();
+    prepared.insertRows_.clear();
+    prepared.insertTypes_.clear();
+    prepared.outputs_.clear();
+    prepared.assignments_.clear();
+    prepared.predicate_ = {};
+    prepared.joinPredicate_ = {};
+    if (const auto *insertStmt = dynamic_cast<const InsertStatement *>(stmt)) {
+        const auto &table = m_database.getTable(insertStmt->tableName);
+        const auto &columns = table.get_scheme();
+        auto offsets = table.get_column_to_row_offset();
+
+        // defaults are evaluated here once rather than for every row, and
+        // only for the columns the statement leaves out
+        std::vector<std::optional<DBType>> defaults(columns.size());
+        std::vector<bool> hasDefault(columns.size());
+        for (size_t i = 0; i < columns.size(); ++i) {
+            hasDefault[i] = columns[i].isAutoIncrement || columns[i].hasDefault;
+        }
+        auto defaultValue = [&](size_t i) -> const DBType & {
+            if (defaults[i]) {
+                return *defaults[i];
+            }
+            if (columns[i].isAutoIncrement) {
+                defaults[i] = DBType(0);
+            } else {
+                try {
+                    defaults[i] = calc.evaluate(columns[i].defaultValue);
+                } catch (const std::exception &e) {
+                    throw std::runtime_error(
+                        "Error evaluating default value for column " +
+                        columns[i].name + ": " + e.what());
+                }
+            }
+            return *defaults[i];
+        };
+        prepared.insertTypes_.resize(columns.size());
+        for (size_t i = 0; i < columns.size(); ++i) {
+            prepared.insertTypes_[i] = columns[i].type;
+        }
+
+        if (!insertStmt->isMapFormat) {
+            prepared.values_.resize(insertStmt->moreValues.size() + 1);
+            prepared.insertRows_.resize(prepared.values_.size());
+            for (size_t tuple = 0; tuple < prepared.values_.size(); ++tuple) {
+                const auto &values = tuple == 0
+                                         ? insertStmt->values
+                                         : insertStmt->moreValues[tuple - 1];
+                if (values.size() > columns.size()) {
                     throw std::runtime_error("Too many values provided");
                 }
 
-                std::vector<DBType> row(columns.size());
+                auto &compiled = prepared.values_[tuple];
+                auto &row = prepared.insertRows_[tuple];
+                compiled.resize(values.size());
+                row.resize(columns.size());
                 for (size_t i = 0; i < columns.size(); ++i) {
                     const auto &column = columns[i];
-                    try {
-                        if (i < insertStmt->values.size()) {
-                            if (insertStmt->values[i].empty()) {
-                                if (column.isAutoIncrement) {
-                                    row[i] = 0;
-                                } else if (column.hasDefault) {
-                                    row[i] = calc.evaluate(column.defaultValue);
-                                } else {
-                                    throw std::runtime_error(
-                                        "No default value for column " +
-                                        column.name);
-                                }
-                            } else if (insertStmt->values[i] == "NULL") {
-                                if (column.isAutoIncrement) {
-                                    row[i] = 0;
-                                } else if (column.hasDefault) {
-                                    row[i] = calc.evaluate(column.defaultValue);
-                                } else {
-                                    if (column.type == DataTypeName::INT)
-                                        row[i] = 0;
-                                    else if (column.type ==
-                                             DataTypeName::DOUBLE)
-                                        row[i] = 0.0;
-                                    else if (column.type == DataTypeName::BOOL)
-                                        row[i] = false;
-                                    else if (column.type ==
-                                             DataTypeName::STRING)
-                                        row[i] = std::string("");
-                                    else if (column.type ==
-                                             DataTypeName::BYTEBUFFER)
-                                        row[i] = {};
-                                }
-                            } else {
-                                auto value =
-                                    calc.evaluate(insertStmt->values[i]);
-                                if ((column.type == DataTypeName::INT &&
-                                     !std::holds_alternative<int>(value)) ||
-                                    (column.type == DataTypeName::DOUBLE &&
-                                     !std::holds_alternative<double>(value)) ||
-                                    (column.type == DataTypeName::BOOL &&
-                                     !std::holds_alternative<bool>(value)) ||
-                                    (column.type == DataTypeName::STRING &&
-                                     !std::holds_alternative<std::string>(
-                                         value)) ||
-                                    (column.type == DataTypeName::BYTEBUFFER &&
-                                     !std::holds_alternative<bytebuffer>(
-                                         value))) {
-                                    throw std::runtime_error(
-                                        "Type mismatch for column " +
-                                        column.name);
-                                }
-                                row[i] = value;
-                            }
-                        } else if (column.isAutoIncrement) {
-                            row[i] = 0;
-                        } else if (column.hasDefault) {
-                            row[i] = calc.evaluate(column.defaultValue);
-                        } else {
+                    if (i < values.size() && !values[i].empty() &&
+                        values[i] != "NULL") {
+                        try {
+                            compiled[i] = calc.compile(values[i], noColumns);
+                        } catch (const std::exception &e) {
                             throw std::runtime_error(
-                                "No value provided for column " + column.name);
+                                "Error processing value for column " +
+                                column.name + ": " + e.what());
                         }
-                    } catch (const std::exception &e) {
+                    } else if (hasDefault[i]) {
+                        row[i] = defaultValue(i);
+                    } else if (i < values.size() && values[i] == "NULL") {
+                        row[i] = zeroValue(column.type);
+                    } else {
                         throw std::runtime_error(
-                            "Error processing value for column " + column.name +
-                            ": " + e.what());
+                            "Error processing value for column " +
+                            column.name + ": " +
+                            (i < values.size() ? "No default value"
+                                               : "No value provided") +
+                            " for column " + column.name);
                     }
                 }
-                m_database.insertInto(insertStmt->tableName, row);
+            }
+        } else {
+            std::unordered_set<std::string> providedColumns;
+
+            for (const auto &[columnName, value] :
+                 insertStmt->columnValuePairs) {
+                if (!offsets.count(columnName)) {
+                    throw std::runtime_error("Unknown column: " + columnName);
+                }
+                if (!providedColumns.insert(columnName).second) {
+                    throw std::runtime_error(
+                        "Duplicate column in assignment: " + columnName);
+                }
+            }
+
+            for (const auto &column : columns) {
+                if (!column.hasDefault && !column.isAutoIncrement &&
+                    !providedColumns.count(column.name)) {
+                    throw std::runtime_error(
+                        "Missing value for required column: " + column.name);
+                }
+            }
+
+            prepared.values_.resize(1);
+            prepared.values_[0].resize(columns.size());
+            for (const auto &[columnName, valueExpr] :
+                 insertStmt->columnValuePairs) {
+                try {
+                    prepared.values_[0][offsets[columnName]] =
+                        calc.compile(valueExpr, noColumns);
+                } catch (const std::exception &e) {
+                    throw std::runtime_error(
+                        "Error processing value for column " + columnName +
+                        ": " + e.what());
+                }
+            }
+            prepared.insertRows_.resize(1);
+            auto &row = prepared.insertRows_[0];
+            row.resize(columns.size());
+            for (size_t i = 0; i < columns.size(); ++i) {
+                bool useDefault =
+                    hasDefault[i] && !providedColumns.count(columns[i].name);
+                row[i] = useDefault ? defaultValue(i)
+                                    : zeroValue(columns[i].type);
+            }
+        }
+    } else if (const auto *selectStmt =
+                   dynamic_cast<const SelectStatement *>(stmt)) {
+        const Table &table = m_database.getTable(selectStmt->tableName);
+        Table emptyTable = {};
+        const Table &foreignTable =
+            selectStmt->foreignTableName.empty()
+                ? emptyTable
+                : m_database.getTable(selectStmt->foreignTableName);
+        auto offsets = table.get_column_to_row_offset();
+        auto foreignOffsets = foreignTable.get_column_to_row_offset();
+        const auto scheme = table.get_scheme();
+        const auto foreignScheme = foreignTable.get_scheme();
+
+        for (const auto &column : selectStmt->columnData) {
+            if (column.name == "*") {
+                break;
+            }
+            if (column.table.empty()) {
+                if (!offsets.count(column.name)) {
+                    throw std::invalid_argument(
+                        "Invalid selector: " + column.name + ".");
+                }
             } else {
-                std::vector<DBType> row(columns.size());
-                std::unordered_set<std::string> providedColumns;
-
-                for (const auto &[columnName, value] :
-                     insertStmt->columnValuePairs) {
-                    if (!offsets.count(columnName)) {
-                        throw std::runtime_error("Unknown column: " +
-                                                 columnName);
-                    }
-                    if (!providedColumns.insert(columnName).second) {
+                if (m_database.hasTable(column.table)) {
+                    if (column.table == selectStmt->tableName) {
+                        if (!offsets.count(column.name)) {
+                            throw std::invalid_argument(
+                                "Invalid selector: " + column.table + "." +
+                                column.name + ".");
+                        }
+                    } else if (column.table == selectStmt->foreignTableName) {
+                        if (!foreignOffsets.count(column.name)) {
+                            throw std::invalid_argument(
+                                "Invalid selector: " + column.table + "." +
+                                column.name + ".");
+                        }
+                    } else {
                         throw std::runtime_error(
-                            "Duplicate column in assignment: " + columnName);
+                            "Unknown table in selector: " + column.table);
                     }
+                } else {
+                    throw std::runtime_error("Unknown table in selector: " +
+                                             column.table);
                 }
+            }
+        }
 
-                for (const auto &column : columns) {
-                    if (!column.hasDefault && !column.isAutoIncrement &&
-                        !providedColumns.count(column.name)) {
-                        throw std::runtime_error(
-                            "Missing value for required column: " +
-                            column.name);
-                    }
+        if (selectStmt->foreignTableName.empty()) {
+            if (selectStmt->columnData[0].name == "*") {
+                for (const auto &[name, index] : offsets) {
+                    prepared.outputs_.push_back(
+                        {name, {0, index, scheme[index].type}});
+                }
+            } else {
+                for (const auto &columnItem : selectStmt->columnData) {
+                    size_t offset = offsets[columnItem.name];
+                    prepared.outputs_.push_back(
+                        {columnItem.name, {0, offset, scheme[offset].type}});
                 }
+            }
 
-                for (size_t i = 0; i < columns.size(); ++i) {
-                    const auto &column = columns[i];
-                    if (!providedColumns.count(column.name)) {
-                        if (column.isAutoIncrement) {
-                            row[i] = 0;
-                        } else if (column.hasDefault) {
-                            try {
-                                row[i] = calc.evaluate(column.defaultValue);
-                            } catch (const std::exception &e) {
-                                throw std::runtime_error(
-                                    "Error evaluating default value for "
-                                    "column " +
-                                    column.name + ": " + e.what());
-                            }
-                        } else {
-                            if (column.type == DataTypeName::INT)
-                                row[i] = 0;
-                            else if (column.type == DataTypeName::DOUBLE)
-                                row[i] = 0.0;
-                            else if (column.type == DataTypeName::BOOL)
-                                row[i] = false;
-                            else if (column.type == DataTypeName::STRING)
-                                row[i] = std::string("");
-                            else if (column.type == DataTypeName::BYTEBUFFER)
-                                row[i] = {};
-                        }
+            if (!selectStmt->predicate.empty()) {
+                prepared.predicate_ =
+                    calc.compile(selectStmt->predicate, scheme);
+            }
+        } else {
+            if (selectStmt->columnData[0].name == "*") {
+                for (const auto &[name, index] : offsets) {
+                    prepared.outputs_.push_back(
+                        {selectStmt->tableName + '.' + name,
+                         {0, index, scheme[index].type}});
+                }
+                for (const auto &[name, index] : foreignOffsets) {
+                    prepared.outputs_.push_back(
+                        {selectStmt->foreignTableName + '.' + name,
+                         {1, index, foreignScheme[index].type}});
+                }
+            } else {
+                for (const auto &columnItem : selectStmt->columnData) {
+                    calculator::ColumnSlot slot;
+                    if (columnItem.table == selectStmt->tableName) {
+                        size_t offset = offsets[columnItem.name];
+                        slot = {0, offset, scheme[offset].type};
+                    } else {
+                        size_t offset = foreignOffsets[columnItem.name];
+                        slot = {1, offset, foreignScheme[offset].type};
                     }
+                    prepared.outputs_.push_back(
+                        {columnItem.table + '.' + columnItem.name, slot});
                 }
+            }
 
-                for (const auto &[columnName, valueExpr] :
-                     insertStmt->columnValuePairs) {
-                    size_t columnIndex = offsets[columnName];
-                    const auto &column = columns[columnIndex];
-
-                    try {
-                        auto value = calc.evaluate(valueExpr);
-                        if ((column.type == DataTypeName::INT &&
-                             !std::holds_alternative<int>(value)) ||
-                            (column.type == DataTypeName::DOUBLE &&
-                             !std::holds_alternative<double>(value)) ||
-                            (column.type == DataTypeName::BOOL &&
-                             !std::holds_alternative<bool>(value)) ||
-                            (column.type == DataTypeName::STRING &&
-                             !std::holds_alternative<std::string>(value)) ||
-                            (column.type == DataTypeName::BYTEBUFFER &&
-                             !std::holds_alternative<bytebuffer>(value))) {
-                            throw std::runtime_error(
-                                "Type mismatch for column " + columnName);
-                        }
-                        row[columnIndex] = value;
-                    } catch (const std::exception &e) {
-                        throw std::runtime_error(
-                            "Error processing value for column " + columnName +
-                            ": " + e.what());
-                    }
+            calculator::ColumnBinding binding;
+            calculator::Calculator::bindColumns(binding, scheme, 0,
+                                                selectStmt->tableName);
+            calculator::Calculator::bindColumns(binding, foreignScheme, 1,
+                                                selectStmt->foreignTableName);
+
+            prepared.joinPredicate_ =
+                calc.compile(selectStmt->joinPredicate, binding);
+            if (!selectStmt->predicate.empty()) {
+                prepared.predicate_ =
+                    calc.compile(selectStmt->predicate, binding);
+            }
+        }
+    } else if (const auto *updateStmt =
+                   dynamic_cast<const UpdateStatement *>(stmt)) {
+        const Table &table = m_database.getTable(updateStmt->tableName);
+        Table emptyTable = {};
+        const Table &foreignTable =
+            updateStmt->foreignTableName.empty()
+                ? emptyTable
+                : m_database.getTable(updateStmt->foreignTableName);
+        auto offsets = table.get_column_to_row_offset();
+        auto foreignOffsets = foreignTable.get_column_to_row_offset();
+
+        // check if columns are valid
+        for (const auto &[columnData, value] : updateStmt->newValues) {
+            if (!offsets.count(columnData.name)) {
+                if (!updateStmt->foreignTableName.empty() ||
+                    !foreignOffsets.count(columnData.name)) {
+                    throw std::invalid_argument(
+                        "Invalid value name: " + columnData.name + ".");
                 }
+            }
 
-                m_database.insertInto(insertStmt->tableName, row);
+            auto column = table.get_scheme()[offsets[columnData.name]];
+            if (!updateStmt->foreignTableName.empty() &&
+                columnData.table == updateStmt->foreignTableName) {
+                column =
+                    foreignTable.get_scheme()[foreignOffsets[columnData.name]];
             }
-        } else if (const auto *selectStmt =
-                       dynamic_cast<const SelectStatement *>(stmt.get())) {
-            auto table = m_database.getTable(selectStmt->tableName);
-            Table foreignTable;
-            if (!selectStmt->foreignTableName.empty()) {
-                foreignTable =
-                    m_database.getTable(selectStmt->foreignTableName);
+
+            if (column.isAutoIncrement) {
+                throw std::invalid_argument(
+                    "Cannot update autoincrement column: " + columnData.name +
+                    ".");
             }
 
-            std::vector<ResultRowType> result_rows;
+            if (column.isKey) {
+                throw std::invalid_argument("Cannot update key column: " +
+                                            columnData.name + ".");
+            }
 
-            for (const auto &column : selectStmt->columnData) {
-                if (column.name == "*") {
-                    break;
-                }
-                if (column.table.empty()) {
-                    if (!table.get_column_to_row_offset().count(column.name)) {
-                        throw std::invalid_argument(
-                            "Invalid selector: " + column.name + ".");
-                    }
+            if (column.isUnique) {
+                throw std::invalid_argument("Cannot update unique column: " +
+                                            columnData.name + ".");
+            }
+        }
+
+        if (updateStmt->foreignTableName.empty()) {
+            for (const auto &[columnItem, value] : updateStmt->newValues) {
+                size_t offset = offsets[columnItem.name];
+                prepared.assignments_.emplace_back(
+                    calculator::ColumnSlot{0, offset,
+                                           table.get_scheme()[offset].type},
+                    calc.compile(value, table.get_scheme()));
+            }
+            if (!updateStmt->predicate.empty()) {
+                prepared.predicate_ =
+                    calc.compile(updateStmt->predicate, table.get_scheme());
+            }
+        } else {
+            calculator::ColumnBinding binding;
+            calculator::Calculator::bindColumns(binding, table.get_scheme(), 0,
+                                                updateStmt->tableName);
+            calculator::Calculator::bindColumns(
+                binding, foreignTable.get_scheme(), 1,
+                updateStmt->foreignTableName);
+
+            prepared.joinPredicate_ =
+                calc.compile(updateStmt->joinPredicate, binding);
+            if (!updateStmt->predicate.empty()) {
+                prepared.predicate_ =
+                    calc.compile(updateStmt->predicate, binding);
+            }
+
+            for (const auto &[key, value] : updateStmt->newValues) {
+                calculator::ColumnSlot slot;
+                if (key.table == updateStmt->tableName) {
+                    size_t offset = offsets[key.name];
+                    slot = {0, offset, table.get_scheme()[offset].type};
                 } else {
-                    if (m_database.hasTable(column.table)) {
-                        if (column.table == selectStmt->tableName) {
-                            if (!table.get_column_to_row_offset().count(
-                                    column.name)) {
-                                throw std::invalid_argument(
-                                    "Invalid selector: " + column.table + "." +
-                                    column.name + ".");
-                            }
-                        } else if (column.table ==
-                                   selectStmt->foreignTableName) {
-                            if (!foreignTable.get_column_to_row_offset().count(
-                                    column.name)) {
-                                throw std::invalid_argument(
-                                    "Invalid selector: " + column.table + "." +
-                                    column.name + ".");
-                            }
-                        } else {
-                            throw std::runtime_error(
-                                "Unknown table in selector: " + column.table);
-                        }
-                    } else {
-                        throw std::runtime_error("Unknown table in selector: " +
-                                                 column.table);
-                    }
+                    size_t offset = foreignOffsets[key.name];
+                    slot = {1, offset, foreignTable.get_scheme()[offset].type};
                 }
+                prepared.assignments_.emplace_back(
+                    slot, calc.compile(value, binding));
             }
+        }
+    } else if (const auto *deleteStmt =
+                   dynamic_cast<const DeleteStatement *>(stmt)) {
+        if (!deleteStmt->predicate.empty()) {
+            prepared.predicate_ = calc.compile(
+                deleteStmt->predicate,
+                m_database.getTable(deleteStmt->tableName).get_scheme());
+        }
+    }
+    prepared.catalogVersion_ = m_database.catalogVersion();
+}
 
-            if (selectStmt->foreignTableName.empty()) {
-                // handling select without join
-                auto filter_predicate = [table, foreignTable, selectStmt,
-                                         calc](const std::vector<DBType> &row) {
-                    std::unordered_map<std::string, std::string> row_values =
-                        {};
-
-                    for (const auto &[name, index] :
-                         table.get_column_to_row_offset()) {
-                        row_values[name] = dBTypeToString(row[index]);
-                    }
+void MemoryTracker::allocate(size_t bytes) {
+    used_ += bytes;
+    peak_ = std::max(peak_, used_);
+    if (limit_ != 0 && used_ > limit_) {
+        throw std::runtime_error("Query memory limit of " +
+                                 std::to_string(limit_) + " bytes exceeded.");
+    }
+}
 
-                    return calculator::safeGet<bool>(
-                        calc.evaluate(selectStmt->predicate, row_values));
-                };
+// Memory of rows copied from a table by Table::read_rows.
+size_t cellsMemoryUsage(const std::pmr::vector<DBType> &cells) {
+    size_t bytes = cells.capacity() * sizeof(DBType);
+    for (const auto &cell : cells) {
+        bytes += memoryUsage(cell) - sizeof(DBType);
+    }
+    return bytes;
+}
 
-                auto rows = !selectStmt->predicate.empty()
-                                ? table.filter(filter_predicate)
-                                : table.get_rows();
+// Copies the rows of table to cells. Their size is charged before they are
+// copied, so that the limit stops the copy, and the strings they hold once
+// they are.
+void readRows(const Table &table, std::pmr::vector<DBType> &cells,
+              MemoryTracker &memory) {
+    size_t estimate = table.size() * table.column_count() * sizeof(DBType);
+    memory.allocate(estimate);
+    table.read_rows(cells);
+    size_t used = cellsMemoryUsage(cells);
+    if (used > estimate) {
+        memory.allocate(used - estimate);
+    }
+}
 
-                for (const auto &column : rows) {
+// Evaluates the values of one INSERT tuple into row, which holds the
+// defaults of the other columns, and checks their types.
+void fillInsertRow(RowType &row, const std::vector<DataTypeName> &types,
+                   const std::vector<calculator::CompiledExpression> &compiled,
+                   const Table &table) {
+    for (size_t i = 0; i < compiled.size(); ++i) {
+        if (compiled[i].empty()) {
+            continue;
+        }
+        try {
+            row[i] = compiled[i].evaluate({});
+            if (!hasType(row[i], types[i])) {
+                throw std::runtime_error("Type mismatch for column " +
+                                         table.get_scheme()[i].name);
+            }
+        } catch (const std::exception &e) {
+            throw std::runtime_error("Error processing value for column " +
+                                     table.get_scheme()[i].name + ": " +
+                                     e.what());
+        }
+    }
+}
+
+Result Executor::execute(PreparedStatement &prepared) {
+    Result result = {};
+    MemoryTracker memory(m_memoryLimit);
+    // Scratch data of the statement (rows copied for joins, flags) is
+    // taken from this arena and freed at once when execute returns.
+    std::pmr::monotonic_buffer_resource scratch(m_scratchResource);
+    try {
+        // offsets, defaults and constraints are read again if a table or
+        // an index was created since the statement was compiled
+        if (prepared.catalogVersion_ != m_database.catalogVersion()) {
+            compile(prepared);
+        }
+        for (size_t i = 0; i < prepared.bound_.size(); ++i) {
+            if (!prepared.bound_[i]) {
+                throw std::invalid_argument("Parameter ?" +
+                                            std::to_string(i + 1) +
+                                            " is not bound.");
+            }
+        }
+        for (auto &tuple : prepared.values_) {
+            for (auto &expression : tuple) {
+                expression.bind(prepared.parameters_);
+            }
+        }
+        for (auto &[slot, expression] : prepared.assignments_) {
+            expression.bind(prepared.parameters_);
+        }
+        prepared.predicate_.bind(prepared.parameters_);
+        prepared.joinPredicate_.bind(prepared.parameters_);
+
+        const SQLStatement *stmt = prepared.statement_.get();
+        if (const auto *createStmt =
+                dynamic_cast<const CreateTableStatement *>(stmt)) {
+            m_database.createTable(createStmt->tableName, createStmt->columns,
+                                   createStmt->storage);
+        } else if (const auto *insertStmt =
+                       dynamic_cast<const InsertStatement *>(stmt)) {
+            // the rows start from the defaults evaluated by compile, so only
+            // the given values are computed here
+            Table &table = m_database.getTable(insertStmt->tableName);
+            if (prepared.values_.size() == 1) {
+                RowType row = prepared.insertRows_[0];
+                fillInsertRow(row, prepared.insertTypes_, prepared.values_[0],
+                              table);
+                table.insert_row(std::move(row));
+            } else {
+                std::vector<RowType> rows = prepared.insertRows_;
+                for (size_t tuple = 0; tuple < rows.size(); ++tuple) {
+                    fillInsertRow(rows[tuple], prepared.insertTypes_,
+                                  prepared.values_[tuple], table);
+                    memory.allocate(memoryUsage(rows[tuple]));
+                }
+                m_database.insertRows(insertStmt->tableName, std::move(rows));
+            }
+        } else if (const auto *selectStmt =
+                       dynamic_cast<const SelectStatement *>(stmt)) {
+            const Table &table = m_database.getTable(selectStmt->tableName);
+            std::vector<ResultRowType> result_rows;
+
+            if (selectStmt->foreignTableName.empty()) {
+                // handling select without join: only the selected columns
+                // of the matching rows are read
+                TableView view = table.view(prepared.predicate_);
+                memory.allocate(view.size() *
+                                (sizeof(size_t) + sizeof(ResultRowType)));
+                result_rows.reserve(view.size());
+                for (size_t i = 0; i < view.size(); ++i) {
                     std::unordered_map<std::string, DBType> row = {};
-                    if (selectStmt->columnData[0].name == "*") {
-                        for (const auto &[name, index] :
-                             table.get_column_to_row_offset()) {
-                            row[name] = column[index];
-                        }
-                    } else {
-                        for (const auto &columnItem : selectStmt->columnData) {
-                            row[columnItem.name] =
-                                column[table.get_column_to_row_offset()
-                                           [columnItem.name]];
-                        }
+                    row.reserve(prepared.outputs_.size());
+                    for (const auto &[name, slot] : prepared.outputs_) {
+                        row[name] = view.value(i, slot.offset);
                     }
-                    result_rows.emplace_back(row);
+                    memory.allocate(memoryUsage(row) - sizeof(ResultRowType));
+                    result_rows.emplace_back(std::move(row));
                 }
             } else {
                 // handling select with join
-                auto rows = table.get_rows();
-
-                auto foreignRows = foreignTable.get_rows();
-
-                for (const auto &column : rows) {
-                    for (const auto &foreignColumn : foreignRows) {
-                        std::unordered_map<std::string, std::string>
-                            row_values = {};
-
-                        for (const auto &[name, index] :
-                             table.get_column_to_row_offset()) {
-                            row_values[selectStmt->tableName + '.' + name] =
-                                dBTypeToString(column[index]);
-                        }
-                        for (const auto &[name, index] :
-                             foreignTable.get_column_to_row_offset()) {
-                            row_values[selectStmt->foreignTableName + '.' +
-                                       name] =
-                                dBTypeToString(foreignColumn[index]);
-                        }
-
-                        if (!calculator::safeGet<bool>(calc.evaluate(
-                                selectStmt->joinPredicate, row_values))) {
+                const Table &foreignTable =
+                    m_database.getTable(selectStmt->foreignTableName);
+                const auto &joinPredicate = prepared.joinPredicate_;
+                const auto &wherePredicate = prepared.predicate_;
+
+                // no pair can match, so the tables are not even read; a
+                // self-join reads its table once
+                bool canMatch = !joinPredicate.alwaysFalse() &&
+                                !wherePredicate.alwaysFalse();
+                bool selfJoin = &foreignTable == &table;
+                std::pmr::vector<DBType> cells(&scratch);
+                std::pmr::vector<DBType> otherCells(&scratch);
+                if (canMatch) {
+                    readRows(table, cells, memory);
+                    if (!selfJoin) {
+                        readRows(foreignTable, otherCells, memory);
+                    }
+                }
+                const auto &foreignCells = selfJoin ? cells : otherCells;
+                size_t width = table.column_count();
+                size_t foreignWidth = foreignTable.column_count();
+
+                for (size_t i = 0; i < cells.size(); i += width) {
+                    const DBType *column = cells.data() + i;
+                    for (size_t j = 0; j < foreignCells.size();
+                         j += foreignWidth) {
+                        const DBType *foreignColumn = foreignCells.data() + j;
+                        if (!calculator::safeGet<bool>(joinPredicate.evaluate(
+                                column, foreignColumn))) {
                             continue;
                         }
 
-                        if (!selectStmt->predicate.empty() &&
-                            !calculator::safeGet<bool>(calc.evaluate(
-                                selectStmt->predicate, row_values))) {
+                        if (!wherePredicate.empty() &&
+                            !calculator::safeGet<bool>(wherePredicate.evaluate(
+                                column, foreignColumn))) {
                             continue;
                         }
 
                         std::unordered_map<std::string, DBType> row = {};
-                        if (selectStmt->columnData[0].name == "*") {
-                            for (const auto &[name, index] :
-                                 table.get_column_to_row_offset()) {
-                                row[selectStmt->tableName + '.' + name] =
-                                    column[index];
-                            }
-                            for (const auto &[name, index] :
-                                 foreignTable.get_column_to_row_offset()) {
-                                row[selectStmt->foreignTableName + '.' + name] =
-                                    foreignColumn[index];
-                            }
-                        } else {
-                            for (const auto &columnItem :
-                                 selectStmt->columnData) {
-                                if (columnItem.table == selectStmt->tableName) {
-                                    row[columnItem.table + '.' +
-                                        columnItem.name] =
-                                        column[table.get_column_to_row_offset()
-                                                   [columnItem.name]];
-                                } else {
-                                    row[columnItem.table + '.' +
-                                        columnItem.name] = foreignColumn
-                                        [foreignTable.get_column_to_row_offset()
-                                             [columnItem.name]];
-                                }
-                            }
+                        row.reserve(prepared.outputs_.size());
+                        for (const auto &[name, slot] : prepared.outputs_) {
+                            row[name] = slot.row == 0
+                                            ? column[slot.offset]
+                                            : foreignColumn[slot.offset];
                         }
-                        result_rows.emplace_back(row);
+                        memory.allocate(memoryUsage(row));
+                        result_rows.emplace_back(std::move(row));
                     }
                 }
             }
 
             result = Result(std::move(result_rows));
         } else if (const auto *updateStmt =
-                       dynamic_cast<const UpdateStatement *>(stmt.get())) {
+                       dynamic_cast<const UpdateStatement *>(stmt)) {
             Table &table = m_database.getTable(updateStmt->tableName);
-            Table emptyTable = {};
-            Table &foreignTable =
-                updateStmt->foreignTableName.empty()
-                    ? emptyTable
-                    : m_database.getTable(updateStmt->foreignTableName);
-
-            // check if columns are valid
-            for (const auto &[columnData, value] : updateStmt->newValues) {
-                if (!table.get_column_to_row_offset().count(columnData.name)) {
-                    if (!updateStmt->foreignTableName.empty() ||
-                        !foreignTable.get_column_to_row_offset().count(
-                            columnData.name)) {
-                        throw std::invalid_argument(
-                            "Invalid value name: " + columnData.name + ".");
-                    }
-                }
-
-                auto column =
-                    table.get_scheme()
-                        [table.get_column_to_row_offset()[columnData.name]];
-                if (!updateStmt->foreignTableName.empty() &&
-                    columnData.table == updateStmt->foreignTableName) {
-                    column =
-                        foreignTable.get_scheme()
-                            [foreignTable
-                                 .get_column_to_row_offset()[columnData.name]];
-                }
-
-                if (column.isAutoIncrement) {
-                    throw std::invalid_argument(
-                        "Cannot update autoincrement column: " +
-                        columnData.name + ".");
-                }
-
-                if (column.isKey) {
-                    throw std::invalid_argument(
-                        "Cannot update key column: " + columnData.name + ".");
-                }
-
-                if (column.isUnique) {
-                    throw std::invalid_argument(
-                        "Cannot update unique column: " + columnData.name +
-                        ".");
-                }
-            }
+            const auto &assignments = prepared.assignments_;
 
             if (updateStmt->foreignTableName.empty()) {
                 // handle update without join
-                auto updater = [table, updateStmt,
-                                calc](std::vector<DBType> &row) {
-                    std::unordered_map<std::string, std::string> row_values =
-                        {};
-                    for (const auto &[name, index] :
-                         table.get_column_to_row_offset()) {
-                        row_values[name] = dBTypeToString(row[index]);
+                auto updater = [&assignments](std::vector<DBType> &row) {
+                    std::vector<DBType> newValues;
+                    newValues.reserve(assignments.size());
+                    for (const auto &[slot, expression] : assignments) {
+                        newValues.push_back(expression.evaluate(row));
                     }
-
-                    for (const auto &[columnItem, value] :
-                         updateStmt->newValues) {
-                        row[table.get_column_to_row_offset()[columnItem.name]] =
-                            calc.evaluate(value, row_values);
+                    for (size_t i = 0; i < assignments.size(); ++i) {
+                        row[assignments[i].first.offset] =
+                            std::move(newValues[i]);
                     }
                 };
 
-                if (updateStmt->predicate.empty()) {
-                    table.update_many(
-                        updater,
-                        []([[maybe_unused]] const std::vector<DBType> &row) {
-                            return true;
-                        });
-                } else {
-                    auto filter_predicate =
-                        [table, updateStmt,
-                         calc](const std::vector<DBType> &row) {
-                            std::unordered_map<std::string, std::string>
-                                row_values = {};
-                            for (const auto &[name, index] :
-                                 table.get_column_to_row_offset()) {
-                                auto value = row[index];
-                                row_values[name] = dBTypeToString(row[index]);
-                            }
-                            try {
-                                auto result =
-                                    calculator::safeGet<bool>(calc.evaluate(
-                                        updateStmt->predicate, row_values));
-                                return result;
-                            } catch (const std::exception &e) {
-                                throw;
-                            }
-                        };
-
-                    table.update_many(updater, filter_predicate);
-                }
+                // the selected ids and the updated copies of their rows
+                calculator::SelectionVector rows =
+                    table.select_rows(prepared.predicate_);
+                memory.allocate(rows.size() *
+                                (sizeof(size_t) +
+                                 table.column_count() * sizeof(DBType)));
+                table.update_rows(rows, updater);
             } else {
                 // handle update with join
-
-                auto &rows = table.get_rows();
-
-                auto &foreignRows = foreignTable.get_rows();
-
-                for (auto &column : rows) {
-                    for (auto &foreignColumn : foreignRows) {
-                        std::unordered_map<std::string, std::string>
-                            row_values = {};
-
-                        for (const auto &[name, index] :
-                             table.get_column_to_row_offset()) {
-                            row_values[updateStmt->tableName + '.' + name] =
-                                dBTypeToString(column[index]);
-                        }
-                        for (const auto &[name, index] :
-                             foreignTable.get_column_to_row_offset()) {
-                            row_values[updateStmt->foreignTableName + '.' +
-                                       name] =
-                                dBTypeToString(foreignColumn[index]);
-                        }
-
-                        if (!calculator::safeGet<bool>(calc.evaluate(
-                                updateStmt->joinPredicate, row_values))) {
+                Table &foreignTable =
+                    m_database.getTable(updateStmt->foreignTableName);
+
+                const auto &joinPredicate = prepared.joinPredicate_;
+                const auto &wherePredicate = prepared.predicate_;
+                bool canMatch = !joinPredicate.alwaysFalse() &&
+                                !wherePredicate.alwaysFalse();
+
+                // rows are updated in copies, which are written back to the
+                // tables once every pair has been processed
+                std::pmr::vector<DBType> cells(&scratch);
+                std::pmr::vector<DBType> foreignCells(&scratch);
+                std::vector<size_t> ids;
+                std::vector<size_t> foreignIds;
+                if (canMatch) {
+                    memory.allocate((table.size() + foreignTable.size()) *
+                                    (sizeof(size_t) + 1));
+                    readRows(table, cells, memory);
+                    readRows(foreignTable, foreignCells, memory);
+                    ids = table.get_row_ids();
+                    foreignIds = foreignTable.get_row_ids();
+                }
+                size_t width = table.column_count();
+                size_t foreignWidth = foreignTable.column_count();
+                std::pmr::vector<uint8_t> changed(ids.size(), &scratch);
+                std::pmr::vector<uint8_t> foreignChanged(foreignIds.size(),
+                                                         &scratch);
+
+                std::vector<DBType> newValues(assignments.size());
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    DBType *column = cells.data() + i * width;
+                    for (size_t j = 0; j < foreignIds.size(); ++j) {
+                        DBType *foreignColumn =
+                            foreignCells.data() + j * foreignWidth;
+                        if (!calculator::safeGet<bool>(joinPredicate.evaluate(
+                                column, foreignColumn))) {
                             continue;
                         }
 
-                        if (!updateStmt->predicate.empty() &&
-                            !calculator::safeGet<bool>(calc.evaluate(
-                                updateStmt->predicate, row_values))) {
+                        if (!wherePredicate.empty() &&
+                            !calculator::safeGet<bool>(wherePredicate.evaluate(
+                                column, foreignColumn))) {
                             continue;
                         }
 
-                        for (auto [key, value] : updateStmt->newValues) {
-                            if (key.table == updateStmt->tableName) {
-                                column[table.get_column_to_row_offset()
-                                           [key.name]] =
-                                    calc.evaluate(value, row_values);
+                        for (size_t k = 0; k < assignments.size(); ++k) {
+                            newValues[k] = assignments[k].second.evaluate(
+                                column, foreignColumn);
+                        }
+                        for (size_t k = 0; k < assignments.size(); ++k) {
+                            const auto &slot = assignments[k].first;
+                            auto &target =
+                                slot.row == 0 ? column : foreignColumn;
+                            target[slot.offset] = std::move(newValues[k]);
+                            if (slot.row == 0) {
+                                changed[i] = 1;
                             } else {
-                                foreignColumn[foreignTable
-                                                  .get_column_to_row_offset()
-                                                      [key.name]] =
-                                    calc.evaluate(value, row_values);
+                                foreignChanged[j] = 1;
                             }
                         }
                     }
+                }
 
-                    // table.update_many(updater, filter_predicate);
+                // both tables are checked before either is written, so a
+                // rejected row leaves them unchanged
+                std::vector<std::pair<size_t, RowType>> updates;
+                std::vector<std::pair<size_t, RowType>> foreignUpdates;
+                for (size_t i = 0; i < ids.size(); ++i) {
+                    if (changed[i]) {
+                        const DBType *row = cells.data() + i * width;
+                        updates.emplace_back(ids[i],
+                                             RowType(row, row + width));
+                    }
                 }
+                for (size_t j = 0; j < foreignIds.size(); ++j) {
+                    if (foreignChanged[j]) {
+                        const DBType *row =
+                            foreignCells.data() + j * foreignWidth;
+                        foreignUpdates.emplace_back(
+                            foreignIds[j], RowType(row, row + foreignWidth));
+                    }
+                }
+                table.check_rows(updates);
+                foreignTable.check_rows(foreignUpdates);
+                table.set_rows(updates);
+                foreignTable.set_rows(foreignUpdates);
             }
         } else if (const auto *deleteStmt =
-                       dynamic_cast<const DeleteStatement *>(stmt.get())) {
+                       dynamic_cast<const DeleteStatement *>(stmt)) {
             Table &table = m_database.getTable(deleteStmt->tableName);
 
-            if (deleteStmt->predicate.empty()) {
+            if (prepared.predicate_.empty()) {
                 table.drop_rows();
             } else {
-                // build the predicate
-                auto filter_predicate = [table, deleteStmt,
-                                         calc](const std::vector<DBType> &row) {
-                    std::unordered_map<std::string, std::string> row_values =
-                        {};
-                    for (const auto &[name, index] :
-                         table.get_column_to_row_offset()) {
-                        row_values[name] = dBTypeToString(row[index]);
-                    }
-                    return calculator::safeGet<bool>(
-                        calc.evaluate(deleteStmt->predicate, row_values));
-                };
-
-                table.remove_many(filter_predicate);
+                calculator::SelectionVector rows =
+                    table.select_rows(prepared.predicate_);
+                memory.allocate(rows.size() * sizeof(size_t));
+                table.remove_rows(rows);
             }
         } else if (const auto *createIndexStmt =
-                       dynamic_cast<const CreateIndexStatement *>(stmt.get())) {
-            Table &table = m_database.getTable(createIndexStmt->tableName);
+                       dynamic_cast<const CreateIndexStatement *>(stmt)) {
             std::string indexTypeStr =
                 (createIndexStmt->indexType == IndexType::ORDERED)
                     ? "ordered"
                     : "unordered";
-            table.createIndex(indexTypeStr, createIndexStmt->columns);
+            m_database.createIndex(createIndexStmt->tableName, indexTypeStr,
+                                   createIndexStmt->columns);
         } else {
             throw std::runtime_error("Unsupported SQL statement.");
         }
     } catch (const std::exception &e) {
         result = Result::errorResult(std::string(e.what()));
     }
+    m_lastQueryMemory = memory.peak();
     return result;
 }
 
-std::string preprocess(std::string query) {
-    std::unordered_map<std::string, std::string> keywords = {
-            {"create table ", "CREATE TABLE "},
-            {"insert ", "INSERT "},
-            {" where ", " WHERE "},
-            {" by ", " BY "},
-            {" on ", " ON "},
-            {" join ", " JOIN "},
-            {"select ", "SELECT "},
-            {"update ", "UPDATE "},
-            {"create index ", "CREATE INDEX "}
-    };
-
-    for (const auto &[key, value] : keywords) {
-        size_t pos = 0;
-        while ((pos = query.find(key, pos)) != std::string::npos) {
-            query.replace(pos, key.length(), value);
-            pos += value.length();
+Result Executor::execute(std::shared_ptr<SQLStatement> stmt) {
+    PreparedStatement prepared;
+    prepared.statement_ = std::move(stmt);
+    try {
+        compile(prepared);
+    } catch (const std::exception &e) {
+        return Result::errorResult(std::string(e.what()));
+    }
+    return execute(prepared);
+}
+
+// Rewrites each '?' outside of string literals as '?N', numbering the
+// parameters from 1 in order of appearance.
+std::string numberParameters(const std::string &query, size_t &count) {
+    std::string result;
+    bool inString = false;
+    for (char c : query) {
+        result += c;
+        if (c == '"') {
+            inString = !inString;
+        } else if (c == '?' && !inString) {
+            result += std::to_string(++count);
         }
     }
+    return result;
+}
+
+// Replaces the number and string literals of an INSERT, SELECT, UPDATE or
+// DELETE statement with numbered parameters and collects their values, so
+// statements that differ only in literals share a plan. Returns false for
+// other statements and for SQL that is left to the parser to report
+// (placeholders, escapes, unterminated strings, numbers that do not fit).
+bool normalizeLiterals(const std::string &sql, std::string &shape,
+                       std::vector<DBType> &literals) {
+    size_t begin = 0;
+    while (begin < sql.size() && std::isspace(sql[begin])) {
+        ++begin;
+    }
+    std::string keyword;
+    for (size_t i = begin; i < sql.size() && std::isalpha(sql[i]); ++i) {
+        keyword += static_cast<char>(std::tolower(sql[i]));
+    }
+    if (keyword != "insert" && keyword != "select" && keyword != "update" &&
+        keyword != "delete") {
+        return false;
+    }
 
-    return query;
+    shape.clear();
+    shape.reserve(sql.size());
+    for (size_t i = 0; i < sql.size();) {
+        char c = sql[i];
+        if (c == '?' || c == '\\') {
+            return false;
+        }
+        if (c == '"') {
+            size_t end = sql.find('"', i + 1);
+            if (end == std::string::npos) {
+                return false;
+            }
+            literals.emplace_back(sql.substr(i + 1, end - i - 1));
+            shape += '?' + std::to_string(literals.size());
+            i = end + 1;
+            continue;
+        }
+        if (std::isalnum(c) || c == '_' || c == '.') {
+            size_t end = i;
+            while (end < sql.size() &&
+                   (std::isalnum(sql[end]) || sql[end] == '_' ||
+                    sql[end] == '.')) {
+                ++end;
+            }
+            bool isNumber = end - i > 1 || c != '.';
+            bool hasDot = false;
+            for (size_t j = i; j < end && isNumber; ++j) {
+                hasDot |= sql[j] == '.';
+                isNumber = std::isdigit(sql[j]) || sql[j] == '.';
+            }
+            if (isNumber) {
+                std::string word = sql.substr(i, end - i);
+                try {
+                    if (hasDot) {
+                        literals.emplace_back(std::stod(word));
+                    } else {
+                        literals.emplace_back(std::stoi(word));
+                    }
+                } catch (const std::exception &) {
+                    return false;
+                }
+                shape += '?' + std::to_string(literals.size());
+            } else {
+                shape.append(sql, i, end - i);
+            }
+            i = end;
+            continue;
+        }
+        shape += c;
+        ++i;
+    }
+    return true;
 }
 
 Result Executor::execute(const std::string &sql) {
     try {
-        std::shared_ptr<SQLStatement> stmt = Parser::parse(preprocess(sql));
+        std::string shape;
+        std::vector<DBType> literals;
+        if (m_planCache.capacity() > 0 &&
+            normalizeLiterals(sql, shape, literals)) {
+            PreparedStatement *prepared =
+                m_planCache.find(shape, m_database.catalogVersion());
+            PreparedStatement uncached;
+            if (prepared == nullptr) {
+                uncached = prepare(Parser::parse(shape), literals.size());
+                // Multi-row INSERT shapes depend on the batch size and would
+                // only crowd out reusable plans.
+                prepared = uncached.values_.size() > 1
+                               ? &uncached
+                               : &m_planCache.insert(shape,
+                                                     std::move(uncached));
+            }
+            for (size_t i = 0; i < literals.size(); ++i) {
+                prepared->bind(i + 1, std::move(literals[i]));
+            }
+            return execute(*prepared);
+        }
+
+        std::shared_ptr<SQLStatement> stmt = Parser::parse(sql);
         return Executor::execute(stmt);
     } catch (const std::exception &e) {
         return Result::errorResult(std::string(e.what()));
     }
 }
 
+PreparedStatement Executor::prepare(const std::string &sql) {
+    size_t count = 0;
+    std::string numbered = numberParameters(sql, count);
+    return prepare(Parser::parse(numbered), count);
+}
+
+PreparedStatement Executor::prepare(std::shared_ptr<SQLStatement> stmt,
+                                    size_t parameterCount) {
+    PreparedStatement prepared;
+    prepared.statement_ = std::move(stmt);
+    prepared.parameters_.resize(parameterCount);
+    prepared.bound_.assign(parameterCount, false);
+    compile(prepared);
+    return prepared;
+}
+
 }  // namespace database
@@ -4,8 +4,15 @@
 #ifndef DATABASE_CONTROLLER_HSE_EXECUTOR_H
 #define DATABASE_CONTROLLER_HSE_EXECUTOR_H
 
+#include <algorithm>
+#include <list>
 #include <memory>
+#include <memory_resource>
+#include <string>
+#include <unordered_map>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include "../../Calculator/Calculator.h"
 #include "../../database/Database/Database.h"
@@ -14,14 +21,134 @@
 #include "../Parser/Parser.h"
 
 namespace database {
+
+// Statement parsed and compiled once by Executor::prepare. Every '?' in the
+// SQL is a parameter, numbered from 1 in order of appearance; all of them
+// must be bound before execution and keep their values between executions.
+// A statement compiled before the catalog changed is compiled again when it
+// is executed.
+class PreparedStatement {
+   public:
+    size_t parameterCount() const { return parameters_.size(); }
+    void bind(size_t index, DBType value);
+    // Database::catalogVersion the statement was last compiled against.
+    size_t catalogVersion() const { return catalogVersion_; }
+
+   private:
+    friend class Executor;
+
+    std::shared_ptr<SQLStatement> statement_;
+    std::vector<DBType> parameters_;
+    std::vector<bool> bound_;
+    size_t catalogVersion_ = 0;
+
+    // INSERT: value expressions of each VALUES tuple by position, or a
+    // single entry by column offset (map form); empty where the column
+    // default is used
+    std::vector<std::vector<calculator::CompiledExpression>> values_;
+    // INSERT: each tuple as a row holding the column defaults, evaluated
+    // once by compile, which values_ are evaluated into; and the type each
+    // value must have
+    std::vector<RowType> insertRows_;
+    std::vector<DataTypeName> insertTypes_;
+    // SELECT: result column names and where their values are read from
+    std::vector<std::pair<std::string, calculator::ColumnSlot>> outputs_;
+    // UPDATE: target slot (row 0 or 1, offset) and the value expression
+    std::vector<std::pair<calculator::ColumnSlot,
+                          calculator::CompiledExpression>>
+        assignments_;
+    calculator::CompiledExpression predicate_;
+    calculator::CompiledExpression joinPredicate_;
+};
+
+// LRU cache of prepared statements keyed by SQL text with its literals
+// replaced by '?'. All entries are dropped when the database catalog changes.
+class PlanCache {
+   public:
+    static constexpr size_t kDefaultCapacity = 128;
+
+    explicit PlanCache(size_t capacity = kDefaultCapacity)
+        : capacity_(capacity) {}
+
+    PreparedStatement* find(const std::string& key, size_t catalogVersion);
+    PreparedStatement& insert(const std::string& key,
+                              PreparedStatement statement);
+    void clear();
+
+    // A capacity of 0 disables the cache.
+    void setCapacity(size_t capacity);
+    size_t capacity() const { return capacity_; }
+    size_t size() const { return entries_.size(); }
+    size_t hits() const { return hits_; }
+    size_t misses() const { return misses_; }
+
+   private:
+    using Entry = std::pair<std::string, PreparedStatement>;
+
+    size_t capacity_;
+    size_t catalogVersion_ = 0;
+    size_t hits_ = 0;
+    size_t misses_ = 0;
+    std::list<Entry> entries_;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+// Bytes held by a running statement: materialized rows, selected row ids
+// and result rows. Going over a nonzero limit throws, which execute turns
+// into an error result.
+class MemoryTracker {
+   public:
+    explicit MemoryTracker(size_t limit = 0) : limit_(limit) {}
+
+    void allocate(size_t bytes);
+    void release(size_t bytes) { used_ -= std::min(bytes, used_); }
+
+    size_t limit() const { return limit_; }
+    size_t used() const { return used_; }
+    size_t peak() const { return peak_; }
+
+   private:
+    size_t limit_;
+    size_t used_ = 0;
+    size_t peak_ = 0;
+};
+
 class Executor {
 public:
     Executor(Database& database) : m_database(database) {}
 
     Result execute(std::shared_ptr<SQLStatement> stmt);
     Result execute(const std::string &sql);
+
+    // Throws if the statement cannot be parsed or refers to unknown tables
+    // or columns.
+    PreparedStatement prepare(const std::string &sql);
+    Result execute(PreparedStatement &stmt);
+
+    // Used by execute(const std::string &) for INSERT, SELECT, UPDATE and
+    // DELETE statements.
+    PlanCache &planCache() { return m_planCache; }
+
+    // Memory budget of every statement in bytes, 0 for none.
+    void setMemoryLimit(size_t bytes) { m_memoryLimit = bytes; }
+    size_t memoryLimit() const { return m_memoryLimit; }
+    // Peak memory of the last executed statement.
+    size_t lastQueryMemory() const { return m_lastQueryMemory; }
+    // Resource the scratch arena of every statement grows from.
+    void setScratchResource(std::pmr::memory_resource *resource) {
+        m_scratchResource = resource;
+    }
 private:
+    PreparedStatement prepare(std::shared_ptr<SQLStatement> stmt,
+                              size_t parameterCount);
+    void compile(PreparedStatement &stmt);
+
     Database& m_database;
+    PlanCache m_planCache;
+    size_t m_memoryLimit = 0;
+    size_t m_lastQueryMemory = 0;
+    std::pmr::memory_resource *m_scratchResource =
+        std::pmr::get_default_resource();
 };
 
 }  // namespace database
@@ -1,6 +1,7 @@
 #include <gtest/gtest.h>
 
 #include <chrono>
+#include <memory_resource>
 
 #include "../../database/Database/Database.h"
 #include "../AST/SQLStatement.h"
@@ -9,6 +10,28 @@
 
 using namespace database;
 
+// Counts the blocks taken from the default resource, for the allocation
+// benchmarks.
+class CountingResource : public std::pmr::memory_resource {
+   public:
+    size_t allocations = 0;
+    size_t bytes = 0;
+
+   private:
+    void* do_allocate(size_t size, size_t alignment) override {
+        ++allocations;
+        bytes += size;
+        return std::pmr::get_default_resource()->allocate(size, alignment);
+    }
+    void do_deallocate(void* pointer, size_t size, size_t alignment) override {
+        std::pmr::get_default_resource()->deallocate(pointer, size, alignment);
+    }
+    bool do_is_equal(
+        const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
 class ExecutorTest : public ::testing::Test {
    protected:
     Database db;
@@ -33,7 +56,7 @@ TEST_F(ExecutorTest, ExecuteInsert) {
     executor.execute(insertStmt);
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 1);
     EXPECT_EQ(std::get<int>(data[0][0]), 1);
     EXPECT_EQ(std::get<std::string>(data[0][1]), "Alice");
@@ -47,7 +70,7 @@ TEST_F(ExecutorTest, ExecuteInsertRegister) {
     executor.execute(insertStmt);
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 1);
     EXPECT_EQ(std::get<int>(data[0][0]), 1);
     EXPECT_EQ(std::get<std::string>(data[0][1]), "Alice");
@@ -64,7 +87,7 @@ TEST_F(ExecutorTest, ExecuteMultipleInserts) {
     executor.execute(insertStmt2);
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 2);
     EXPECT_EQ(std::get<int>(data[0][0]), 1);
     EXPECT_EQ(std::get<std::string>(data[0][1]), "Alice");
@@ -80,7 +103,7 @@ TEST_F(ExecutorTest, ExecuteInsertWithExpression) {
     executor.execute(insertStmt);
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 1);
     EXPECT_EQ(std::get<int>(data[0][0]), 1);
     EXPECT_EQ(std::get<std::string>(data[0][1]), "Alice");
@@ -95,7 +118,7 @@ TEST_F(ExecutorTest, ExecuteInsertWithBoolean) {
     executor.execute(insertStmt);
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 1);
     EXPECT_EQ(std::get<int>(data[0][0]), 1);
     EXPECT_EQ(std::get<std::string>(data[0][1]), "Alice");
@@ -135,7 +158,7 @@ TEST_F(ExecutorTest, ExecuteComplexInsert) {
     executor.execute(insertStmt);
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 1);
     EXPECT_EQ(std::get<int>(data[0][0]), 1);
     EXPECT_EQ(std::get<std::string>(data[0][1]), "Alice");
@@ -183,7 +206,7 @@ TEST_F(ExecutorTest, ComplexScenario) {
         executor.execute(stmt);
     }
 
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 4);
 
     EXPECT_EQ(std::get<int>(data[0][0]), 1);
@@ -267,7 +290,7 @@ TEST_F(ExecutorTest, AutoIncrement) {
     executor.execute(insertStmt5);
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 5);
     EXPECT_EQ(std::get<int>(data[0][0]), 0);
     EXPECT_EQ(std::get<int>(data[1][0]), 1);
@@ -297,7 +320,7 @@ TEST_F(ExecutorTest, MultipleAutoIncrement) {
     executor.execute(insertStmt3);
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 3);
     EXPECT_EQ(std::get<int>(data[0][0]), 0);
     EXPECT_EQ(std::get<int>(data[0][1]), 0);
@@ -387,7 +410,7 @@ TEST_F(ExecutorTest, ExecuteInvalidInsertWithAssignments) {
     EXPECT_FALSE(result4.is_ok());
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 0);
 }
 
@@ -406,7 +429,7 @@ TEST_F(ExecutorTest, ExecuteInsertWithPartialAssignments) {
     EXPECT_TRUE(result.is_ok());
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 1);
     EXPECT_EQ(std::get<int>(data[0][0]), 1);
     EXPECT_EQ(std::get<int>(data[0][2]), 25);
@@ -427,7 +450,7 @@ TEST_F(ExecutorTest, ExecuteInsertWithMixedSyntax) {
     EXPECT_TRUE(result2.is_ok());
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 2);
 
     EXPECT_EQ(std::get<int>(data[0][0]), 1);
@@ -455,7 +478,7 @@ TEST_F(ExecutorTest, ExecuteInsertWithDefaults) {
 
     {
         auto& table = db.getTable("Test");
-        auto& data = table.get_rows();
+        const auto& data = table.get_rows();
         ASSERT_EQ(data.size(), 1);
         EXPECT_EQ(std::get<int>(data[0][0]), 1);
         EXPECT_EQ(std::get<std::string>(data[0][1]), "Unknown");
@@ -471,7 +494,7 @@ TEST_F(ExecutorTest, ExecuteInsertWithDefaults) {
     EXPECT_TRUE(result2.is_ok());
     {
         auto& table = db.getTable("Test");
-        auto& data = table.get_rows();
+        const auto& data = table.get_rows();
         ASSERT_EQ(data.size(), 2);
         EXPECT_EQ(std::get<int>(data[1][0]), 2);
         EXPECT_EQ(std::get<std::string>(data[1][1]), "John");
@@ -480,6 +503,41 @@ TEST_F(ExecutorTest, ExecuteInsertWithDefaults) {
     }
 }
 
+TEST_F(ExecutorTest, InsertPlanFillsDefaultsAndKeepsSequence) {
+    executor.execute(
+        "CREATE TABLE Test (ID INT AUTOINCREMENT, Code INT UNIQUE, "
+        "Name VARCHAR DEFAULT \"Unknown\", Score DOUBLE DEFAULT 0.0);");
+
+    EXPECT_TRUE(executor.execute("INSERT INTO Test VALUES (NULL, 1, , 2.5);")
+                    .is_ok());
+    EXPECT_TRUE(executor.execute("INSERT INTO Test (Code = 2);").is_ok());
+    // a failed insert does not use up an AUTOINCREMENT value
+    EXPECT_FALSE(executor.execute("INSERT INTO Test (Code = 2);").is_ok());
+    EXPECT_FALSE(
+        executor.execute("INSERT INTO Test VALUES (NULL, 3, 4, 1.5);").is_ok());
+    EXPECT_FALSE(
+        executor.execute("INSERT INTO Test VALUES (NULL, \"3\");").is_ok());
+    EXPECT_TRUE(executor.execute("INSERT INTO Test VALUES (NULL, 3, \"x\", "
+                                 "NULL), (NULL, 4, , 0.5);")
+                    .is_ok());
+
+    // the cached plan is rebuilt once the catalog changes
+    executor.execute("CREATE ORDERED INDEX ON Test BY Code;");
+    EXPECT_TRUE(executor.execute("INSERT INTO Test (Code = 5);").is_ok());
+
+    const auto& data = db.getTable("Test").get_rows();
+    ASSERT_EQ(data.size(), 5);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(std::get<int>(data[i][0]), i);
+        EXPECT_EQ(std::get<int>(data[i][1]), i + 1);
+    }
+    EXPECT_EQ(std::get<std::string>(data[0][2]), "Unknown");
+    EXPECT_EQ(std::get<double>(data[1][3]), 0.0);
+    EXPECT_EQ(std::get<std::string>(data[2][2]), "x");
+    EXPECT_EQ(std::get<double>(data[3][3]), 0.5);
+    EXPECT_EQ(std::get<std::string>(data[4][2]), "Unknown");
+}
+
 TEST_F(ExecutorTest, ComplexTableOperations) {
     auto createStmt =
         "CREATE TABLE Employees ("
@@ -763,6 +821,274 @@ TEST_F(ExecutorTest, ExecuteSelectWithPredicate) {
     EXPECT_EQ(std::get<std::string>(rows[1]["Name"]), "Charlie");
 }
 
+TEST_F(ExecutorTest, ExecuteSelectWithTypedPredicate) {
+    auto createStmt =
+        ("CREATE TABLE Test (ID INT, Code VARCHAR, Active BOOL, Score "
+         "DOUBLE);");
+    executor.execute(createStmt);
+
+    executor.execute("INSERT INTO Test VALUES (1, \"007\", true, 1.5);");
+    executor.execute("INSERT INTO Test VALUES (2, \"008\", false, 2.5);");
+    executor.execute("INSERT INTO Test VALUES (3, \"007\", false, 3.5);");
+
+    auto result = executor.execute(
+        "SELECT ID FROM Test WHERE Code == \"007\" && Active == false;");
+    ASSERT_TRUE(result.is_ok());
+    auto rows = result.get_payload();
+    ASSERT_EQ(rows.size(), 1);
+    EXPECT_EQ(std::get<int>(rows[0]["ID"]), 3);
+
+    result = executor.execute("SELECT ID FROM Test WHERE Score >= 2.5;");
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_EQ(result.get_payload().size(), 2);
+}
+
+TEST_F(ExecutorTest, ExecuteSelectWithConstantPredicate) {
+    executor.execute("CREATE TABLE Test (ID INT, Age INT);");
+    executor.execute("INSERT INTO Test VALUES (1, 20);");
+    executor.execute("INSERT INTO Test VALUES (2, 30);");
+
+    auto result =
+        executor.execute("SELECT ID FROM Test WHERE Age > 20 + 5 && true;");
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_payload().size(), 1);
+    EXPECT_EQ(std::get<int>(result.get_payload()[0]["ID"]), 2);
+
+    result = executor.execute("SELECT ID FROM Test WHERE Age > 0 && 1 == 2;");
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_TRUE(result.get_payload().empty());
+}
+
+TEST_F(ExecutorTest, ExecutePreparedStatements) {
+    executor.execute("CREATE TABLE Test (ID INT, Name VARCHAR, Age INT);");
+
+    auto insert = executor.prepare("INSERT INTO Test VALUES (?, ?, ? + 1);");
+    ASSERT_EQ(insert.parameterCount(), 3);
+    for (int i = 0; i < 10; ++i) {
+        insert.bind(1, i);
+        insert.bind(2, std::string("Name?") + std::to_string(i));
+        insert.bind(3, 20 + i);
+        ASSERT_TRUE(executor.execute(insert).is_ok());
+    }
+
+    auto select = executor.prepare(
+        "SELECT Name FROM Test WHERE Age > ? && Name != \"?\";");
+    ASSERT_EQ(select.parameterCount(), 1);
+    select.bind(1, 25);
+    auto result = executor.execute(select);
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_EQ(result.get_payload().size(), 5);
+
+    select.bind(1, 29);
+    result = executor.execute(select);
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_payload().size(), 1);
+    EXPECT_EQ(std::get<std::string>(result.get_payload()[0]["Name"]),
+              "Name?9");
+
+    auto update = executor.prepare("UPDATE Test SET (Age = ?) WHERE ID == ?;");
+    update.bind(1, 100);
+    update.bind(2, 3);
+    ASSERT_TRUE(executor.execute(update).is_ok());
+    select.bind(1, 99);
+    result = executor.execute(select);
+    ASSERT_EQ(result.get_payload().size(), 1);
+    EXPECT_EQ(std::get<std::string>(result.get_payload()[0]["Name"]),
+              "Name?3");
+
+    // a catalog change makes the next execution compile the statement again
+    size_t version = db.catalogVersion();
+    executor.execute("CREATE ORDERED INDEX ON Test BY Age;");
+    ASSERT_NE(db.catalogVersion(), version);
+    EXPECT_EQ(select.catalogVersion(), version);
+    result = executor.execute(select);
+    ASSERT_TRUE(result.is_ok()) << result.get_error_message();
+    EXPECT_EQ(result.get_payload().size(), 1);
+    EXPECT_EQ(select.catalogVersion(), db.catalogVersion());
+
+    auto remove = executor.prepare("DELETE FROM Test WHERE Age >= ?;");
+    remove.bind(1, 0);
+    ASSERT_TRUE(executor.execute(remove).is_ok());
+    EXPECT_EQ(db.getTable("Test").size(), 0);
+}
+
+TEST_F(ExecutorTest, ExecutePreparedStatementErrors) {
+    executor.execute("CREATE TABLE Test (ID INT, Name VARCHAR);");
+    EXPECT_ANY_THROW(executor.prepare("SELECT ID FROM Missing WHERE ID == ?;"));
+    EXPECT_ANY_THROW(executor.prepare("SELECT ID FROM Test WHERE Age == ?;"));
+
+    auto insert = executor.prepare("INSERT INTO Test VALUES (?, ?);");
+    EXPECT_THROW(insert.bind(3, 1), std::out_of_range);
+    insert.bind(1, 1);
+    EXPECT_FALSE(executor.execute(insert).is_ok());
+    insert.bind(2, 2);
+    EXPECT_FALSE(executor.execute(insert).is_ok());
+    insert.bind(2, std::string("Alice"));
+    EXPECT_TRUE(executor.execute(insert).is_ok());
+
+    EXPECT_FALSE(
+        executor.execute("SELECT ID FROM Test WHERE ID == ?;").is_ok());
+}
+
+TEST_F(ExecutorTest, PlanCacheReusesStatementShapes) {
+    executor.execute("CREATE TABLE Test (ID INT, Name VARCHAR, Score DOUBLE);");
+    auto &cache = executor.planCache();
+    size_t misses = cache.misses();
+
+    for (int i = 0; i < 5; ++i) {
+        auto result = executor.execute("INSERT INTO Test VALUES (" +
+                                       std::to_string(i) + ", \"Name" +
+                                       std::to_string(i) + "\", 1.5);");
+        ASSERT_TRUE(result.is_ok());
+    }
+    EXPECT_EQ(cache.misses(), misses + 1);
+    EXPECT_EQ(cache.hits(), 4);
+
+    auto result = executor.execute(
+        "SELECT Name FROM Test WHERE ID > 2 && Name != \"Name4\";");
+    ASSERT_TRUE(result.is_ok());
+    ASSERT_EQ(result.get_payload().size(), 1);
+    EXPECT_EQ(std::get<std::string>(result.get_payload()[0]["Name"]),
+              "Name3");
+    result = executor.execute(
+        "SELECT Name FROM Test WHERE ID > 0 && Name != \"Name4\";");
+    EXPECT_EQ(result.get_payload().size(), 3);
+    EXPECT_EQ(cache.hits(), 5);
+
+    result = executor.execute("INSERT INTO Test VALUES (5, 1, 1.5);");
+    EXPECT_FALSE(result.is_ok());
+
+    executor.execute("CREATE TABLE Other (ID INT);");
+    misses = cache.misses();
+    result = executor.execute(
+        "SELECT Name FROM Test WHERE ID > 1 && Name != \"Name4\";");
+    EXPECT_EQ(result.get_payload().size(), 2);
+    EXPECT_EQ(cache.misses(), misses + 1);
+    EXPECT_EQ(cache.size(), 1);
+
+    cache.setCapacity(1);
+    executor.execute("SELECT ID FROM Test;");
+    EXPECT_EQ(cache.size(), 1);
+    cache.setCapacity(0);
+    result = executor.execute("SELECT ID FROM Test WHERE ID == 1;");
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_EQ(result.get_payload().size(), 1);
+    EXPECT_EQ(cache.size(), 0);
+}
+
+TEST_F(ExecutorTest, PlanCacheFoldsBoundLiterals) {
+    executor.execute("CREATE TABLE Lhs (ID INT);");
+    executor.execute("CREATE TABLE Rhs (ID INT);");
+    for (int i = 0; i < 20; ++i) {
+        executor.execute("INSERT INTO Lhs VALUES (" + std::to_string(i) +
+                         ");");
+        executor.execute("INSERT INTO Rhs VALUES (" + std::to_string(i) +
+                         ");");
+    }
+
+    // the literals become parameters of the cached plan, but once they are
+    // bound "1 == 0" is still known to be false and the tables are not read
+    for (int i = 0; i < 2; ++i) {
+        auto result = executor.execute(
+            "SELECT Lhs.ID FROM Lhs JOIN Rhs ON Lhs.ID == Rhs.ID WHERE "
+            "1 == 0 && Lhs.ID > 5;");
+        ASSERT_TRUE(result.is_ok()) << result.get_error_message();
+        EXPECT_TRUE(result.get_payload().empty());
+        EXPECT_EQ(executor.lastQueryMemory(), 0);
+    }
+    auto result = executor.execute(
+        "SELECT Lhs.ID FROM Lhs JOIN Rhs ON Lhs.ID == Rhs.ID WHERE "
+        "1 == 1 && Lhs.ID > 5;");
+    ASSERT_TRUE(result.is_ok()) << result.get_error_message();
+    EXPECT_EQ(result.get_payload().size(), 14);
+    EXPECT_GT(executor.lastQueryMemory(), 0);
+    EXPECT_GE(executor.planCache().hits(), 2);
+}
+
+TEST_F(ExecutorTest, ExecuteMultiRowInsert) {
+    executor.execute(
+        "CREATE TABLE Test (ID INT AUTOINCREMENT, Name VARCHAR UNIQUE, "
+        "Score DOUBLE DEFAULT 1.5);");
+
+    auto result = executor.execute(
+        "INSERT INTO Test VALUES (, \"A\", 2.5), (, \"B\", ), "
+        "(7, \"C\", 0.5 * 3);");
+    ASSERT_TRUE(result.is_ok()) << result.get_error_message();
+    EXPECT_EQ(executor.planCache().size(), 0);
+
+    result =
+        executor.execute("SELECT ID, Score FROM Test WHERE Name == \"B\";");
+    ASSERT_EQ(result.get_payload().size(), 1);
+    EXPECT_EQ(std::get<int>(result.get_payload()[0]["ID"]), 1);
+    EXPECT_EQ(std::get<double>(result.get_payload()[0]["Score"]), 1.5);
+
+    result = executor.execute(
+        "INSERT INTO Test VALUES (, \"D\", 1.0), (, \"A\", 1.0);");
+    EXPECT_FALSE(result.is_ok());
+    result = executor.execute(
+        "INSERT INTO Test VALUES (, \"E\", 1.0), (, 1, 1.0);");
+    EXPECT_FALSE(result.is_ok());
+
+    result = executor.execute("SELECT ID FROM Test;");
+    EXPECT_EQ(result.get_payload().size(), 3);
+    ASSERT_TRUE(executor.execute("INSERT INTO Test VALUES (, \"D\", 1.0);")
+                    .is_ok());
+    result = executor.execute("SELECT ID FROM Test WHERE Name == \"D\";");
+    ASSERT_EQ(result.get_payload().size(), 1);
+    EXPECT_EQ(std::get<int>(result.get_payload()[0]["ID"]), 8);
+}
+
+TEST_F(ExecutorTest, InsertEvaluatesOnlyUsedDefaults) {
+    ASSERT_TRUE(executor
+                    .execute("CREATE TABLE Test (ID INT, Bad INT DEFAULT "
+                             "1 / 0, Name VARCHAR DEFAULT \"x\");")
+                    .is_ok());
+
+    EXPECT_TRUE(executor.execute("INSERT INTO Test VALUES (1, 2, );").is_ok());
+    EXPECT_TRUE(
+        executor.execute("INSERT INTO Test (ID = 2, Bad = 3);").is_ok());
+    EXPECT_FALSE(executor.execute("INSERT INTO Test VALUES (3, , );").is_ok());
+    EXPECT_FALSE(executor.execute("INSERT INTO Test (ID = 4);").is_ok());
+
+    auto result = executor.execute("SELECT Bad, Name FROM Test;");
+    ASSERT_EQ(result.get_payload().size(), 2);
+    EXPECT_EQ(std::get<int>(result.get_payload()[1]["Bad"]), 3);
+    EXPECT_EQ(std::get<std::string>(result.get_payload()[1]["Name"]), "x");
+}
+
+TEST_F(ExecutorTest, ExecuteOnColumnarTable) {
+    auto result = executor.execute(
+        "CREATE COLUMNAR TABLE Test (ID INT AUTOINCREMENT, Name VARCHAR, "
+        "Age INT DEFAULT 20, Active BOOL);");
+    ASSERT_TRUE(result.is_ok()) << result.get_error_message();
+    EXPECT_EQ(db.getTable("Test").get_storage(), StorageType::COLUMNAR);
+
+    executor.execute(
+        "INSERT INTO Test VALUES (, \"Alice\", 30, true), "
+        "(, \"Bob\", , false), (, \"Carol\", 41, true);");
+    executor.execute("INSERT INTO Test (Name = \"Dave\", Active = false);");
+    EXPECT_FALSE(
+        executor.execute("INSERT INTO Test VALUES (, \"Eve\", true, true);")
+            .is_ok());
+    ASSERT_EQ(db.getTable("Test").size(), 4);
+
+    result = executor.execute(
+        "SELECT Name FROM Test WHERE Age > 25 && Active == true;");
+    ASSERT_EQ(result.get_payload().size(), 2);
+    EXPECT_EQ(std::get<std::string>(result.get_payload()[1]["Name"]),
+              "Carol");
+
+    executor.execute("UPDATE Test SET (Age = Age + 1) WHERE Age == 20;");
+    result = executor.execute("SELECT ID FROM Test WHERE Age == 21;");
+    ASSERT_EQ(result.get_payload().size(), 2);
+    EXPECT_EQ(std::get<int>(result.get_payload()[0]["ID"]), 1);
+
+    executor.execute("DELETE FROM Test WHERE Active == false;");
+    result = executor.execute("SELECT ID, Name FROM Test;");
+    ASSERT_EQ(result.get_payload().size(), 2);
+    EXPECT_EQ(std::get<int>(result.get_payload()[1]["ID"]), 2);
+}
+
 TEST_F(ExecutorTest, ExecuteBasicUpdate) {
     auto createStmt = ("CREATE TABLE Test (ID INT, Name VARCHAR, Age INT);");
     executor.execute(createStmt);
@@ -865,7 +1191,7 @@ TEST_F(ExecutorTest, ExecuteDeleteAllRows) {
     EXPECT_TRUE(result.is_ok());
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     EXPECT_EQ(data.size(), 0);
 }
 
@@ -885,7 +1211,7 @@ TEST_F(ExecutorTest, ExecuteDeleteWithPredicate) {
     EXPECT_TRUE(result.is_ok());
 
     auto& table = db.getTable("Test");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 1);
     EXPECT_EQ(std::get<std::string>(data[0][1]), "Bob");
 }
@@ -944,7 +1270,7 @@ TEST_F(ExecutorTest, ComplexDatabaseOperations) {
     EXPECT_TRUE(result.is_ok());
 
     auto& table = db.getTable("Employees");
-    auto& data = table.get_rows();
+    const auto& data = table.get_rows();
     ASSERT_EQ(data.size(), 3);
 
     auto selectStmt = ("SELECT * FROM Employees;");
@@ -1070,6 +1396,43 @@ TEST_F(ExecutorTest, QueryPerformanceWithIndex) {
               << std::endl;
 }
 
+TEST_F(ExecutorTest, EqualityWhereUsesIndex) {
+    executor.execute(
+        "CREATE TABLE Users (ID INT KEY, Login VARCHAR, IsAdmin BOOL);");
+    for (int i = 0; i < 1000; ++i) {
+        executor.execute("INSERT INTO Users VALUES (" + std::to_string(i) +
+                         ", \"user" + std::to_string(i % 100) + "\", " +
+                         (i % 2 == 0 ? "true" : "false") + ");");
+    }
+    executor.execute("CREATE UNORDERED INDEX ON Users BY Login, IsAdmin;");
+    const auto& table = db.getTable("Users");
+    size_t lookups = table.index_lookups();
+
+    auto result = executor.execute(
+        "SELECT ID FROM Users WHERE IsAdmin == true && Login == \"user42\" "
+        "&& ID > 500;");
+    ASSERT_TRUE(result.is_ok()) << result.get_error_message();
+    auto rows = result.get_payload();
+    ASSERT_EQ(rows.size(), 5);
+    for (const auto& row : rows) {
+        int id = std::get<int>(row.at("ID"));
+        EXPECT_TRUE(id > 500 && id % 100 == 42);
+    }
+
+    EXPECT_TRUE(
+        executor.execute("UPDATE Users SET (Login = \"root\") WHERE ID == 7;")
+            .is_ok());
+    EXPECT_TRUE(executor.execute("DELETE FROM Users WHERE Login == \"user7\" "
+                                 "&& IsAdmin == false;")
+                    .is_ok());
+    EXPECT_EQ(table.index_lookups(), lookups + 3);
+    EXPECT_EQ(table.size(), 991);
+    EXPECT_NO_THROW(table.verify_indexes());
+    result = executor.execute("SELECT ID FROM Users WHERE Login == \"root\";");
+    ASSERT_EQ(result.get_payload().size(), 1);
+    EXPECT_EQ(std::get<int>(result.get_payload()[0].at("ID")), 7);
+}
+
 TEST_F(ExecutorTest, ComplexQueryWithMultipleIndexes) {
     auto createTableStmt =
         "CREATE TABLE Employees ("
@@ -1309,6 +1672,99 @@ TEST_F(ExecutorTest, UpdateWithJoinAndWhere) {
     EXPECT_EQ(std::get<std::string>(rows[0]["Post.Text"]), "HELLO WORLD 1");
     EXPECT_EQ(std::get<std::string>(rows[1]["User.Name"]), "Alice2");
     EXPECT_EQ(std::get<std::string>(rows[1]["Post.Text"]), "HELLO WORLD 2");
+
+    // a rejected row of either table leaves both of them unchanged
+    result = executor.execute(
+        "UPDATE User JOIN Post ON User.ID == Post.AuthorId SET (User.Age = "
+        "40, Post.ID = \"x\");");
+    EXPECT_FALSE(result.is_ok());
+    for (const auto &user : db.getTable("User").get_rows()) {
+        EXPECT_NE(std::get<int>(user[2]), 40);
+    }
+    for (const auto &post : db.getTable("Post").get_rows()) {
+        EXPECT_TRUE(std::holds_alternative<int>(post[0]));
+    }
+}
+
+TEST_F(ExecutorTest, MemoryLimitStopsLargeJoin) {
+    executor.execute("CREATE TABLE Lhs (ID INT, Tag VARCHAR);");
+    executor.execute("CREATE TABLE Rhs (ID INT, Tag VARCHAR);");
+    for (int i = 0; i < 200; ++i) {
+        executor.execute("INSERT INTO Lhs VALUES (" + std::to_string(i) +
+                         ", \"left\");");
+        executor.execute("INSERT INTO Rhs VALUES (" + std::to_string(i) +
+                         ", \"right\");");
+    }
+
+    auto result =
+        executor.execute("SELECT Lhs.ID, Rhs.ID FROM Lhs JOIN Rhs ON "
+                         "Lhs.Tag != Rhs.Tag;");
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_EQ(result.get_payload().size(), 40000);
+    size_t unlimited = executor.lastQueryMemory();
+
+    executor.setMemoryLimit(unlimited / 4);
+    result = executor.execute(
+        "SELECT Lhs.ID, Rhs.ID FROM Lhs JOIN Rhs ON Lhs.Tag != Rhs.Tag;");
+    EXPECT_FALSE(result.is_ok());
+    EXPECT_LE(executor.lastQueryMemory(), unlimited / 4 + 1024);
+
+    result = executor.execute("SELECT ID FROM Lhs WHERE ID < 10;");
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_EQ(result.get_payload().size(), 10);
+    EXPECT_GT(executor.lastQueryMemory(), 0);
+    EXPECT_LT(executor.lastQueryMemory(), unlimited / 4);
+
+    // the rows of a table are charged before they are copied
+    size_t tableCells = 200 * 2 * sizeof(DBType);
+    executor.setMemoryLimit(tableCells / 2);
+    result = executor.execute(
+        "SELECT Lhs.ID, Rhs.ID FROM Lhs JOIN Rhs ON Lhs.Tag != Rhs.Tag;");
+    EXPECT_FALSE(result.is_ok());
+    EXPECT_EQ(executor.lastQueryMemory(), tableCells);
+
+    executor.setMemoryLimit(0);
+    result = executor.execute(
+        "SELECT Lhs.ID, Rhs.ID FROM Lhs JOIN Rhs ON Lhs.Tag != Rhs.Tag;");
+    EXPECT_TRUE(result.is_ok());
+
+    result = executor.execute("UPDATE Lhs SET (Tag = \"x\") WHERE ID < 10;");
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_GE(executor.lastQueryMemory(), 10 * sizeof(size_t));
+    result = executor.execute("DELETE FROM Lhs WHERE ID < 10;");
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_GE(executor.lastQueryMemory(), 10 * sizeof(size_t));
+}
+
+TEST_F(ExecutorTest, JoinAllocationsDoNotGrowWithRows) {
+    const int rows = 500;
+    executor.execute("CREATE TABLE Lhs (ID INT, Name VARCHAR, Score DOUBLE);");
+    executor.execute("CREATE TABLE Rhs (ID INT, Name VARCHAR, Score DOUBLE);");
+    for (int i = 0; i < rows; ++i) {
+        std::string values = " VALUES (" + std::to_string(i) + ", \"n" +
+                             std::to_string(i) + "\", 1.5);";
+        executor.execute("INSERT INTO Lhs" + values);
+        executor.execute("INSERT INTO Rhs" + values);
+    }
+    const std::string join =
+        "SELECT Lhs.Name FROM Lhs JOIN Rhs ON Lhs.ID == Rhs.ID && "
+        "Lhs.ID < 3;";
+    ASSERT_EQ(executor.execute(join).get_payload().size(), 3);
+
+    // the copies of both tables come from the scratch arena in a few
+    // blocks instead of a vector per row
+    CountingResource counting;
+    executor.setScratchResource(&counting);
+    auto result = executor.execute(join);
+    executor.setScratchResource(std::pmr::get_default_resource());
+    ASSERT_TRUE(result.is_ok());
+    EXPECT_EQ(result.get_payload().size(), 3);
+    EXPECT_GE(counting.bytes, 2 * rows * 3 * sizeof(DBType));
+    EXPECT_LT(counting.allocations, rows / 5);
+    std::cout << "Scratch bytes of the join query: " << counting.bytes
+              << std::endl;
+    std::cout << "Scratch allocations of the join query: "
+              << counting.allocations << std::endl;
 }
 
 int main(int argc, char** argv) {
@@ -73,7 +73,12 @@ std::shared_ptr<SQLStatement> Parser::parseStatement() {
     if (matchKeyword("CREATE")) {
         skipWhitespace();
         if (matchKeyword("TABLE")) {
-            return parseCreateTable();
+            return parseCreateTable(StorageType::ROW);
+        } else if (matchKeyword("COLUMNAR")) {
+            if (!matchKeyword("TABLE")) {
+                throw std::runtime_error("Expected TABLE after COLUMNAR");
+            }
+            return parseCreateTable(StorageType::COLUMNAR);
         } else if (matchKeyword("ORDERED")) {
             return parseCreateIndex(IndexType::ORDERED);
         } else if (matchKeyword("UNORDERED")) {
@@ -100,7 +105,8 @@ std::shared_ptr<SQLStatement> Parser::parseStatement() {
     }
 }
 
-std::shared_ptr<CreateTableStatement> Parser::parseCreateTable() {
+std::shared_ptr<CreateTableStatement> Parser::parseCreateTable(
+    StorageType storage) {
     skipWhitespace();
     std::string tableName = parseIdentifier();
     skipWhitespace();
@@ -113,6 +119,7 @@ std::shared_ptr<CreateTableStatement> Parser::parseCreateTable() {
 
     auto createStmt = std::make_shared<CreateTableStatement>();
     createStmt->tableName = tableName;
+    createStmt->storage = storage;
 
     while (pos_ < sql_.size()) {
         skipWhitespace();
@@ -144,6 +151,12 @@ std::shared_ptr<CreateTableStatement> Parser::parseCreateTable() {
                         "AUTOINCREMENT is only applicable to integer columns.");
                 }
                 column.isAutoIncrement = true;
+            } else if (matchKeyword("DICTIONARY")) {
+                if (column.type != DataTypeName::STRING) {
+                    throw std::runtime_error(
+                        "DICTIONARY is only applicable to VARCHAR columns.");
+                }
+                column.isDictionary = true;
             } else if (matchKeyword("KEY")) {
                 column.isUnique = true;
                 column.isKey = true;
@@ -200,52 +213,16 @@ std::shared_ptr<InsertStatement> Parser::parseInsert() {
     skipWhitespace();
 
     if (flagValues) {
-        std::vector<std::string> values;
-        bool expectValue = true;
-
-        while (pos_ < sql_.size()) {
-            skipWhitespace();
-
-            if (sql_[pos_] == ')') {
-                if (expectValue) {
-                    values.push_back("");
-                }
-                pos_++;
-                break;
-            }
-
-            if (sql_[pos_] == ',') {
-                if (expectValue) {
-                    values.push_back("");
-                }
-                pos_++;
-                expectValue = true;
-                continue;
-            }
-
-            if (!expectValue) {
-                throw std::runtime_error(
-                    "Expected ',' or ')' after value in VALUES clause");
-            }
-
-            std::string value;
-            if (sql_[pos_] == '"') {
-                value = parseStringLiteral();
-            } else {
-                value = parseExpression();
-            }
-
-            if (!value.empty()) {
-                values.push_back(value);
-            } else {
-                values.push_back("");
+        insertStmt->values = parseValues();
+        skipWhitespace();
+        while (matchCharacter(',')) {
+            if (pos_ >= sql_.size() || sql_[pos_] != '(') {
+                throw std::runtime_error("Expected '(' after ',' in VALUES.");
             }
-            expectValue = false;
-
+            pos_++;
+            insertStmt->moreValues.push_back(parseValues());
             skipWhitespace();
         }
-
-        insertStmt->values = values;
     } else {
         insertStmt->isMapFormat = true;
         insertStmt->columnValuePairs = parseAssignValues();
@@ -260,6 +237,55 @@ std::shared_ptr<InsertStatement> Parser::parseInsert() {
     return insertStmt;
 }
 
+std::vector<std::string> Parser::parseValues() {
+    std::vector<std::string> values;
+    bool expectValue = true;
+
+    while (pos_ < sql_.size()) {
+        skipWhitespace();
+
+        if (sql_[pos_] == ')') {
+            if (expectValue) {
+                values.push_back("");
+            }
+            pos_++;
+            break;
+        }
+
+        if (sql_[pos_] == ',') {
+            if (expectValue) {
+                values.push_back("");
+            }
+            pos_++;
+            expectValue = true;
+            continue;
+        }
+
+        if (!expectValue) {
+            throw std::runtime_error(
+                "Expected ',' or ')' after value in VALUES clause");
+        }
+
+        std::string value;
+        if (sql_[pos_] == '"') {
+            value = parseStringLiteral();
+        } else {
+            value = parseExpression();
+        }
+
+        if (!value.empty()) {
+            values.push_back(value);
+        } else {
+            values.push_back("");
+        }
+        expectValue = false;
+
+        skipWhitespace();
+    }
+
+    return values;
+}
+
 std::shared_ptr<SelectStatement> Parser::parseSelect() {
     auto selectStmt = std::make_shared<SelectStatement>();
 
@@ -296,16 +322,9 @@ std::shared_ptr<SelectStatement> Parser::parseSelect() {
         return selectStmt;
     }
 
-    std::string modifier = parseIdentifier();
-
-    if (modifier == "WHERE") {
-        std::string predicate;
-        while (pos_ < sql_.size() && sql_[pos_] != ';') {
-            predicate += sql_[pos_++];
-        }
-        predicate = trim(predicate);
-        selectStmt->predicate = predicate;
-    } else if (modifier == "JOIN") {
+    if (matchKeyword("WHERE")) {
+        selectStmt->predicate = trim(readUntil(';'));
+    } else if (matchKeyword("JOIN")) {
         skipWhitespace();
         selectStmt->foreignTableName = parseIdentifier();
 
@@ -314,27 +333,12 @@ std::shared_ptr<SelectStatement> Parser::parseSelect() {
             throw std::runtime_error("Expected ON after JOIN");
         }
 
-        std::string joinPredicate;
-        while (pos_ < sql_.size() && sql_[pos_] != ';') {
-            if (pos_ + 5 < sql_.size() && sql_.substr(pos_, 5) == "WHERE") {
-                break;
-            }
-            joinPredicate += sql_[pos_++];
-        }
-        joinPredicate = trim(joinPredicate);
-
-        selectStmt->joinPredicate = joinPredicate;
+        selectStmt->joinPredicate = trim(readUntilKeyword("WHERE"));
 
         skipWhitespace();
 
         if (matchKeyword("WHERE")) {
-            std::string predicate;
-            while (pos_ < sql_.size() && sql_[pos_] != ';') {
-                predicate += sql_[pos_++];
-            }
-            predicate = trim(predicate);
-
-            selectStmt->predicate = predicate;
+            selectStmt->predicate = trim(readUntil(';'));
         }
     }
 
@@ -350,9 +354,7 @@ std::shared_ptr<UpdateStatement> Parser::parseUpdate() {
 
     skipWhitespace();
 
-    std::string modifier = parseIdentifier();
-
-    if (modifier == "SET") {
+    if (matchKeyword("SET")) {
         skipWhitespace();
         pos_++;
         std::unordered_map<std::string, std::string> rawValues =
@@ -371,7 +373,7 @@ std::shared_ptr<UpdateStatement> Parser::parseUpdate() {
 
             updateStmt->newValues[column] = value;
         }
-    } else if (modifier == "JOIN") {
+    } else if (matchKeyword("JOIN")) {
         skipWhitespace();
         updateStmt->foreignTableName = parseIdentifier();
 
@@ -380,16 +382,7 @@ std::shared_ptr<UpdateStatement> Parser::parseUpdate() {
             throw std::runtime_error("Expected ON after JOIN");
         }
 
-        std::string joinPredicate;
-        while (pos_ < sql_.size() && sql_[pos_] != ';') {
-            if (pos_ + 3 < sql_.size() && sql_.substr(pos_, 3) == "SET") {
-                break;
-            }
-            joinPredicate += sql_[pos_++];
-        }
-        joinPredicate = trim(joinPredicate);
-
-        updateStmt->joinPredicate = joinPredicate;
+        updateStmt->joinPredicate = trim(readUntilKeyword("SET"));
 
         skipWhitespace();
 
@@ -416,13 +409,8 @@ std::shared_ptr<UpdateStatement> Parser::parseUpdate() {
 
     skipWhitespace();
     if (matchKeyword("WHERE")) {
-        std::string predicate;
         skipWhitespace();
-
-        while (pos_ < sql_.size() && sql_[pos_] != ';') {
-            predicate += sql_[pos_];
-            pos_++;
-        }
+        std::string_view predicate = readUntil(';');
 
         std::string cleanPredicate;
         bool lastWasSpace = true;
@@ -457,12 +445,8 @@ std::shared_ptr<DeleteStatement> Parser::parseDelete() {
     skipWhitespace();
 
     if (matchKeyword("WHERE")) {
-        std::string predicate;
         skipWhitespace();
-
-        while (pos_ < sql_.size() && sql_[pos_] != ';') {
-            predicate += sql_[pos_++];
-        }
+        std::string_view predicate = readUntil(';');
 
         std::string cleanPredicate;
         bool lastWasSpace = true;
@@ -537,7 +521,6 @@ void Parser::skipWhitespace() {
 }
 
 std::string Parser::parseIdentifier() {
-    std::string identifier;
     skipWhitespace();
 
     if (pos_ >= sql_.size()) {
@@ -551,50 +534,86 @@ std::string Parser::parseIdentifier() {
             "Invalid identifier: must start with a letter or underscore");
     }
 
-    identifier += sql_[pos_++];
+    size_t start = pos_++;
     while (pos_ < sql_.size() &&
            (std::isalnum(sql_[pos_]) || sql_[pos_] == '_')) {
-        identifier += sql_[pos_++];
+        pos_++;
     }
 
-    return identifier;
+    return std::string(sql_.substr(start, pos_ - start));
 }
 
 std::string Parser::parseToken() {
-    std::string token;
     skipWhitespace();
 
+    size_t start = pos_;
     while (pos_ < sql_.size() && !std::isspace(sql_[pos_]) &&
            sql_[pos_] != ',' && sql_[pos_] != ')' && sql_[pos_] != ';' &&
            sql_[pos_] != '"') {
-        token += sql_[pos_++];
+        pos_++;
     }
 
-    if (token.empty()) {
+    if (pos_ == start) {
         throw std::runtime_error("Empty token");
     }
 
-    return token;
+    return std::string(sql_.substr(start, pos_ - start));
 }
 
-bool Parser::matchKeyword(const std::string& keyword) {
-    skipWhitespace();
+bool Parser::atKeyword(std::string_view keyword) const {
     size_t len = keyword.length();
 
     if (pos_ + len > sql_.size()) {
         return false;
     }
 
-    if (sql_.substr(pos_, len) == keyword) {
-        if (pos_ + len == sql_.size() || std::isspace(sql_[pos_ + len]) ||
-            sql_[pos_ + len] == '(' || sql_[pos_ + len] == ')' ||
-            sql_[pos_ + len] == ',' || sql_[pos_ + len] == ';') {
-            pos_ += len;
-            skipWhitespace();
-            return true;
+    for (size_t i = 0; i < len; ++i) {
+        if (std::toupper(static_cast<unsigned char>(sql_[pos_ + i])) !=
+            keyword[i]) {
+            return false;
         }
     }
-    return false;
+    return pos_ + len == sql_.size() || std::isspace(sql_[pos_ + len]) ||
+           sql_[pos_ + len] == '(' || sql_[pos_ + len] == ')' ||
+           sql_[pos_ + len] == ',' || sql_[pos_ + len] == ';';
+}
+
+bool Parser::matchKeyword(std::string_view keyword) {
+    skipWhitespace();
+    if (!atKeyword(keyword)) {
+        return false;
+    }
+    pos_ += keyword.length();
+    skipWhitespace();
+    return true;
+}
+
+std::string_view Parser::readUntil(char terminator) {
+    size_t start = pos_;
+    pos_ = std::min(sql_.find(terminator, pos_), sql_.size());
+    return sql_.substr(start, pos_ - start);
+}
+
+std::string_view Parser::readUntilKeyword(std::string_view keyword) {
+    size_t start = pos_;
+    bool inString = false;
+    while (pos_ < sql_.size()) {
+        if (inString) {
+            if (sql_[pos_] == '\\' && pos_ + 1 < sql_.size()) {
+                pos_++;
+            } else if (sql_[pos_] == '"') {
+                inString = false;
+            }
+        } else if (sql_[pos_] == '"') {
+            inString = true;
+        } else if (sql_[pos_] == ';' ||
+                   (pos_ > 0 && std::isspace(sql_[pos_ - 1]) &&
+                    atKeyword(keyword))) {
+            break;
+        }
+        pos_++;
+    }
+    return sql_.substr(start, pos_ - start);
 }
 
 bool Parser::matchCharacter(char expected) {
@@ -608,7 +627,7 @@ bool Parser::matchCharacter(char expected) {
 
 bool Parser::isEnd() const { return pos_ >= sql_.size(); }
 
-std::string Parser::trim(const std::string& s) {
+std::string Parser::trim(std::string_view s) {
     size_t start = 0;
     while (start < s.size() &&
            std::isspace(static_cast<unsigned char>(s[start]))) {
@@ -624,7 +643,7 @@ std::string Parser::trim(const std::string& s) {
         end--;
     }
 
-    return s.substr(start, end - start + 1);
+    return std::string(s.substr(start, end - start + 1));
 }
 
 bool Parser::isBooleanLiteral(const std::string& expr) {
@@ -632,27 +651,24 @@ bool Parser::isBooleanLiteral(const std::string& expr) {
 }
 
 std::string Parser::parseStringLiteral() {
-    std::string value = "\"";
-    pos_++;
+    size_t start = pos_++;
 
     while (pos_ < sql_.size() && sql_[pos_] != '"') {
         if (sql_[pos_] == '\\' && pos_ + 1 < sql_.size()) {
-            value += sql_[pos_++];
+            pos_++;
         }
-        value += sql_[pos_++];
+        pos_++;
     }
 
     if (pos_ >= sql_.size() || sql_[pos_] != '"') {
         throw std::runtime_error("Unterminated string literal");
     }
 
-    value += '"';
     pos_++;
-    return value;
+    return std::string(sql_.substr(start, pos_ - start));
 }
 
 std::string Parser::parseExpression() {
-    std::string value;
     int brackets = 0;
 
     skipWhitespace();
@@ -660,12 +676,13 @@ std::string Parser::parseExpression() {
         return "";
     }
 
+    size_t start = pos_;
     bool expectingMore = false;
     while (pos_ < sql_.size()) {
         char c = sql_[pos_];
 
         if (c == '"') {
-            value += parseStringLiteral();
+            parseStringLiteral();
             expectingMore = false;
             continue;
         }
@@ -690,11 +707,9 @@ std::string Parser::parseExpression() {
             expectingMore = false;
         }
 
-        value += c;
         pos_++;
     }
-    value = trim(value);
-    return value;
+    return trim(sql_.substr(start, pos_ - start));
 }
 
 }  // namespace database
@@ -5,6 +5,7 @@
 #include <memory>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
@@ -19,25 +20,36 @@ class Parser {
    private:
     Parser(const std::string& sql);
     std::shared_ptr<SQLStatement> parseStatement();
-    std::shared_ptr<CreateTableStatement> parseCreateTable();
+    std::shared_ptr<CreateTableStatement> parseCreateTable(StorageType storage);
     std::shared_ptr<InsertStatement> parseInsert();
     std::shared_ptr<SelectStatement> parseSelect();
     std::shared_ptr<UpdateStatement> parseUpdate();
     std::shared_ptr<DeleteStatement> parseDelete();
     std::shared_ptr<CreateIndexStatement> parseCreateIndex(IndexType indexType);
     std::unordered_map<std::string, std::string> parseAssignValues();
+    // Values of one VALUES tuple, starting after its '(' and consuming ')'.
+    std::vector<std::string> parseValues();
 
     void skipWhitespace();
     bool matchCharacter(char expected);
     bool hasInvalidEquals(const std::string& expr);
-    std::string trim(const std::string& s);
+    std::string trim(std::string_view s);
     bool isBooleanLiteral(const std::string& expr);
     std::string parseIdentifier();
     std::string parseToken();
-    bool matchKeyword(const std::string& keyword);
+    // Keywords are given in upper case and matched case-insensitively, and
+    // only where the grammar expects one, so that identifiers spelled like
+    // keywords stay usable.
+    bool atKeyword(std::string_view keyword) const;
+    bool matchKeyword(std::string_view keyword);
+    std::string_view readUntil(char terminator);
+    // Stops before the keyword when it starts a word outside of string
+    // literals, or at ';'.
+    std::string_view readUntilKeyword(std::string_view keyword);
     bool isEnd() const;
 
-    std::string sql_;
+    // the parsed statement; the caller's string outlives the parser
+    std::string_view sql_;
     size_t pos_;
 
     std::string parseStringLiteral();
@@ -31,6 +31,42 @@ TEST_F(ParserTest, ParseInsert) {
     EXPECT_EQ(insertStmt->values[1], "\"Alice\"");
 }
 
+TEST_F(ParserTest, ParseCreateTableStorageOptions) {
+    auto stmt = Parser::parse("CREATE COLUMNAR TABLE Test (ID INT);");
+    auto createStmt = dynamic_cast<CreateTableStatement*>(stmt.get());
+    ASSERT_NE(createStmt, nullptr);
+    EXPECT_EQ(createStmt->storage, StorageType::COLUMNAR);
+    EXPECT_EQ(createStmt->toString(), "CREATE COLUMNAR TABLE Test (ID INT);");
+
+    stmt = Parser::parse("CREATE TABLE Test (ID INT);");
+    createStmt = dynamic_cast<CreateTableStatement*>(stmt.get());
+    EXPECT_EQ(createStmt->storage, StorageType::ROW);
+
+    stmt = Parser::parse(
+        "CREATE TABLE Test (ID INT, Status VARCHAR DICTIONARY UNIQUE);");
+    createStmt = dynamic_cast<CreateTableStatement*>(stmt.get());
+    EXPECT_FALSE(createStmt->columns[0].isDictionary);
+    EXPECT_TRUE(createStmt->columns[1].isDictionary);
+    EXPECT_TRUE(createStmt->columns[1].isUnique);
+    EXPECT_THROW(Parser::parse("CREATE TABLE Test (ID INT DICTIONARY);"),
+                 std::runtime_error);
+}
+
+TEST_F(ParserTest, ParseInsertMultipleRows) {
+    auto stmt = Parser::parse(
+        "INSERT INTO Test VALUES (1, \"Alice\"), (2, ), (3, \"Bob\");");
+    auto insertStmt = dynamic_cast<InsertStatement*>(stmt.get());
+    ASSERT_NE(insertStmt, nullptr);
+    ASSERT_EQ(insertStmt->values.size(), 2);
+    ASSERT_EQ(insertStmt->moreValues.size(), 2);
+    EXPECT_EQ(insertStmt->moreValues[0][0], "2");
+    EXPECT_EQ(insertStmt->moreValues[0][1], "");
+    EXPECT_EQ(insertStmt->moreValues[1][1], "\"Bob\"");
+
+    EXPECT_THROW(Parser::parse("INSERT INTO Test VALUES (1), 2;"),
+                 std::runtime_error);
+}
+
 TEST_F(ParserTest, ParseCreateTableWithAttributes) {
     auto stmt = Parser::parse(
         "CREATE TABLE Test (ID INT AUTOINCREMENT, Name VARCHAR UNIQUE);");
@@ -677,3 +713,74 @@ TEST_F(ParserTest, ParseUpdateWithJoinAndWhere) {
     EXPECT_EQ(updateStmt->predicate, "departments.name == \"Engineering\" AND users.id == 1");
 }
 
+TEST_F(ParserTest, ParseCaseInsensitiveKeywords) {
+    auto stmt = Parser::parse(
+        "select Name from Test join Other on Test.ID == Other.ID "
+        "Where Name == \"select where\";");
+    auto selectStmt = dynamic_cast<SelectStatement*>(stmt.get());
+    ASSERT_NE(selectStmt, nullptr);
+    EXPECT_EQ(selectStmt->tableName, "Test");
+    EXPECT_EQ(selectStmt->foreignTableName, "Other");
+    EXPECT_EQ(selectStmt->joinPredicate, "Test.ID == Other.ID");
+    EXPECT_EQ(selectStmt->predicate, "Name == \"select where\"");
+
+    stmt = Parser::parse("Insert Into Test values (1, \"a\\\"b\");");
+    auto insertStmt = dynamic_cast<InsertStatement*>(stmt.get());
+    ASSERT_NE(insertStmt, nullptr);
+    ASSERT_EQ(insertStmt->values.size(), 2);
+    EXPECT_EQ(insertStmt->values[1], "\"a\\\"b\"");
+
+    stmt = Parser::parse("update Test set (Age = 1) where ID == 2;");
+    auto updateStmt = dynamic_cast<UpdateStatement*>(stmt.get());
+    ASSERT_NE(updateStmt, nullptr);
+    EXPECT_EQ(updateStmt->predicate, "ID == 2");
+
+    stmt = Parser::parse("create unordered index on Test by Name;");
+    ASSERT_NE(dynamic_cast<CreateIndexStatement*>(stmt.get()), nullptr);
+    stmt = Parser::parse("Delete From Test Where ID == 2;");
+    ASSERT_NE(dynamic_cast<DeleteStatement*>(stmt.get()), nullptr);
+}
+
+TEST_F(ParserTest, ParseLowercaseIdentifiersMatchingKeywords) {
+    auto stmt = Parser::parse(
+        "CREATE TABLE values (key INT KEY, columnar VARCHAR, set INT);");
+    auto createStmt = dynamic_cast<CreateTableStatement*>(stmt.get());
+    ASSERT_NE(createStmt, nullptr);
+    EXPECT_EQ(createStmt->tableName, "values");
+    ASSERT_EQ(createStmt->columns.size(), 3);
+    EXPECT_EQ(createStmt->columns[0].name, "key");
+    EXPECT_TRUE(createStmt->columns[0].isKey);
+    EXPECT_EQ(createStmt->columns[1].name, "columnar");
+    EXPECT_EQ(createStmt->columns[2].name, "set");
+
+    stmt = Parser::parse("INSERT INTO values (key = 1, set = 2);");
+    auto insertStmt = dynamic_cast<InsertStatement*>(stmt.get());
+    ASSERT_NE(insertStmt, nullptr);
+    EXPECT_EQ(insertStmt->tableName, "values");
+    EXPECT_TRUE(insertStmt->isMapFormat);
+    EXPECT_EQ(insertStmt->columnValuePairs.at("set"), "2");
+
+    stmt = Parser::parse(
+        "select key, set from values join where on values.key == where.set "
+        "&& values.columnar != \" where \" where set == 2;");
+    auto selectStmt = dynamic_cast<SelectStatement*>(stmt.get());
+    ASSERT_NE(selectStmt, nullptr);
+    ASSERT_EQ(selectStmt->columnData.size(), 2);
+    EXPECT_EQ(selectStmt->columnData[1].name, "set");
+    EXPECT_EQ(selectStmt->tableName, "values");
+    EXPECT_EQ(selectStmt->foreignTableName, "where");
+    EXPECT_EQ(selectStmt->joinPredicate,
+              "values.key == where.set && values.columnar != \" where \"");
+    EXPECT_EQ(selectStmt->predicate, "set == 2");
+
+    stmt = Parser::parse(
+        "update values join set on values.key == set.key && "
+        "set.columnar == \" set \" set (values.set = 1);");
+    auto updateStmt = dynamic_cast<UpdateStatement*>(stmt.get());
+    ASSERT_NE(updateStmt, nullptr);
+    EXPECT_EQ(updateStmt->foreignTableName, "set");
+    EXPECT_EQ(updateStmt->joinPredicate,
+              "values.key == set.key && set.columnar == \" set \"");
+    ASSERT_EQ(updateStmt->newValues.size(), 1);
+    EXPECT_EQ(updateStmt->newValues.begin()->first.name, "set");
+}
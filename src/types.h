@@ -5,12 +5,15 @@
 #ifndef DATABASE_CONTROLLER_HSE_TYPES_H
 #define DATABASE_CONTROLLER_HSE_TYPES_H
 
+#include <functional>
 #include <map>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <variant>
 #include <vector>
 #include <stdexcept>
+#include <type_traits>
 
 namespace database {
     enum DataTypeName {
@@ -30,6 +33,8 @@ struct ColumnDefinition {
     std::string defaultValue;
     bool isAutoIncrement = false;
     bool hasDefault = false;
+    // VARCHAR values are stored as codes into a per-column dictionary
+    bool isDictionary = false;
 
     std::string toString() const { return name + " " + dataTypeNameToString(type); }
 
@@ -69,12 +74,65 @@ using bytebuffer = std::vector<char>;
 
 using DBType = std::variant<int, double, bool, std::string, bytebuffer>;
 
+struct DBTypeHash {
+    size_t operator()(const DBType& value) const {
+        size_t hash = std::visit(
+            [](const auto& v) -> size_t {
+                using T = std::decay_t<decltype(v)>;
+                if constexpr (std::is_same_v<T, bytebuffer>) {
+                    return std::hash<std::string_view>{}(
+                        std::string_view(v.data(), v.size()));
+                } else {
+                    return std::hash<T>{}(v);
+                }
+            },
+            value);
+        return hash ^ (value.index() * 0x9e3779b97f4a7c15ULL);
+    }
+};
+
 using ResultRowType = std::unordered_map<std::string, DBType>;
 
 using RowType = std::vector<DBType>;
 
 using SchemeType = std::vector<ColumnDefinition>;
 
+// Approximate bytes taken by values, including what they allocate, for
+// memory accounting. Strings short enough for the small string buffer
+// allocate nothing.
+inline size_t memoryUsage(const std::string& value) {
+    return sizeof(std::string) +
+           (value.capacity() > 15 ? value.capacity() + 1 : 0);
+}
+
+inline size_t memoryUsage(const DBType& value) {
+    if (const auto* text = std::get_if<std::string>(&value)) {
+        return sizeof(DBType) - sizeof(std::string) + memoryUsage(*text);
+    }
+    if (const auto* buffer = std::get_if<bytebuffer>(&value)) {
+        return sizeof(DBType) + buffer->capacity();
+    }
+    return sizeof(DBType);
+}
+
+inline size_t memoryUsage(const RowType& row) {
+    size_t bytes = sizeof(RowType);
+    for (const auto& value : row) {
+        bytes += memoryUsage(value);
+    }
+    return bytes + (row.capacity() - row.size()) * sizeof(DBType);
+}
+
+// Hash table nodes also hold a next pointer and the cached hash.
+inline size_t memoryUsage(const ResultRowType& row) {
+    size_t bytes =
+        sizeof(ResultRowType) + row.bucket_count() * sizeof(void*);
+    for (const auto& [name, value] : row) {
+        bytes += 2 * sizeof(void*) + memoryUsage(name) + memoryUsage(value);
+    }
+    return bytes;
+}
+
 std::string dBTypeToString(DBType value);
 }  // namespace database
 